@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief Header containing the posted writes and read cache specific
+ * declarations for the Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#ifndef __BUS_CACHE_H__
+#define __BUS_CACHE_H__
+
+#include "qspi_if.h"
+#if defined(CONFIG_NRF700X_BUS_STATIC_DISPATCH) && defined(CONFIG_NRF700X_ON_SPI)
+#include "spi_if.h"
+#endif
+
+#ifdef CONFIG_NRF700X_BUS_STATIC_DISPATCH
+/* Only one bus backend is built and nothing wraps its operations, call it
+ * directly instead of through the qspi_dev function pointers.
+ */
+#ifdef CONFIG_NRF700X_ON_QSPI
+#define ZEP_SHIM_BUS_OP(dev, op) ((void)(dev), qspi_##op)
+#else
+#define ZEP_SHIM_BUS_OP(dev, op) ((void)(dev), spim_##op)
+#endif /* CONFIG_NRF700X_ON_QSPI */
+#else
+#define ZEP_SHIM_BUS_OP(dev, op) ((dev)->op)
+#endif /* CONFIG_NRF700X_BUS_STATIC_DISPATCH */
+
+#ifdef CONFIG_NRF700X_POSTED_WRITES
+/*! \brief Post a word aligned write of whole words
+ *
+ *  Writes extending the pending run are combined with it, any other write
+ *  flushes the run first so that the order of the writes is preserved.
+ *
+ *  \param dev Bus device to write to
+ *  \param addr Word aligned RPU address
+ *  \param src Data to write
+ *  \param nwords Number of words, at most NRF700X_POSTED_WRITES_SIZE / 4
+ */
+void zep_shim_pw_post(struct qspi_dev *dev, unsigned long addr, const void *src,
+		      unsigned int nwords);
+
+/*! \brief Write out the posted writes
+ *
+ *  Needed before anything that can observe them: bus reads, interrupt
+ *  handling and sleep/wake commands.
+ */
+void zep_shim_pw_flush(void);
+#else
+static inline void zep_shim_pw_flush(void)
+{
+}
+#endif /* CONFIG_NRF700X_POSTED_WRITES */
+
+#ifdef CONFIG_NRF700X_READ_CACHE
+/*! \brief Invalidate the whole read cache, on every host interrupt */
+void zep_shim_rc_invalidate_all(void);
+
+/*! \brief Enable or disable the read cache, invalidating it
+ *
+ *  Only enabled while the host interrupt is registered, without it nothing
+ *  would invalidate the lines the RPU updates.
+ */
+void zep_shim_rc_enable(bool enable);
+
+/*! \brief Serve a read of up to one cache line from the read cache
+ *
+ *  \param dev Bus device to fill missing lines from
+ *  \param addr RPU address
+ *  \param dest Destination buffer
+ *  \param count Length in bytes
+ *  \return false if the range is not cacheable or the bus read failed,
+ *          the caller then reads from the bus directly.
+ */
+bool zep_shim_rc_read(struct qspi_dev *dev, unsigned long addr, void *dest, size_t count);
+#else
+static inline void zep_shim_rc_invalidate_all(void)
+{
+}
+
+static inline void zep_shim_rc_enable(bool enable)
+{
+}
+
+static inline void zep_shim_rc_invalidate(unsigned long addr, size_t count)
+{
+}
+
+static inline bool zep_shim_rc_read(struct qspi_dev *dev, unsigned long addr, void *dest,
+				    size_t count)
+{
+	return false;
+}
+#endif /* CONFIG_NRF700X_READ_CACHE */
+
+#endif /* __BUS_CACHE_H__ */
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief Header containing bus owner thread specific declarations for the
+ * Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#ifndef __BUS_OWNER_H__
+#define __BUS_OWNER_H__
+
+#include "qspi_if.h"
+
+/**
+ * struct bus_owner_stats - Bus owner thread statistics.
+ * @high: Number of high priority requests served.
+ * @normal: Number of normal priority requests served.
+ * @preempt: Number of times a normal priority transfer was paused
+ *           between chunks to serve high priority requests.
+ * @direct: Number of requests issued directly by a thread holding the bus
+ *          through bus_begin.
+ */
+struct bus_owner_stats {
+	uint32_t high;
+	uint32_t normal;
+	uint32_t preempt;
+	uint32_t direct;
+};
+
+/*! \brief Get the bus device routed through the bus owner thread
+ *
+ *  The thread is created at boot. The first call selects the bus, later
+ *  calls return the same device.
+ *
+ *  \param bus Bus device whose operations the owner thread executes
+ *  \return Device with synchronous wrappers for the data operations.
+ */
+struct qspi_dev *bus_owner_dev(struct qspi_dev *bus);
+
+void bus_owner_stats_get(struct bus_owner_stats *stats);
+
+#endif /* __BUS_OWNER_H__ */
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief Header containing bus error retry specific declarations for the
+ * Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#ifndef __BUS_RETRY_H__
+#define __BUS_RETRY_H__
+
+#include "qspi_if.h"
+
+enum bus_retry_op {
+	BUS_RETRY_READ,
+	BUS_RETRY_WRITE,
+	BUS_RETRY_HL_READ,
+	BUS_RETRY_READV,
+	BUS_RETRY_WRITEV,
+	BUS_RETRY_OP_NUM,
+};
+
+/**
+ * struct bus_err_stats - Bus error statistics.
+ * @errors: Failed attempts per operation, see enum bus_retry_op.
+ * @recovered: Transfers that succeeded after one or more retries.
+ * @failed: Transfers that still failed after the last retry.
+ * @clock_drops: Times the bus clock was lowered to the wake up frequency.
+ */
+struct bus_err_stats {
+	uint32_t errors[BUS_RETRY_OP_NUM];
+	uint32_t recovered;
+	uint32_t failed;
+	uint32_t clock_drops;
+};
+
+/*! \brief Get the bus device with retries of failed data transfers
+ *
+ *  \param bus Bus device whose data operations are retried
+ *  \return Device with retrying wrappers for the data operations.
+ */
+struct qspi_dev *bus_retry_dev(struct qspi_dev *bus);
+
+void bus_err_stats_get(struct bus_err_stats *stats);
+
+#endif /* __BUS_RETRY_H__ */
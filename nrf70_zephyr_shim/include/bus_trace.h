@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief Header containing bus transaction tracer specific declarations for
+ * the Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#ifndef __BUS_TRACE_H__
+#define __BUS_TRACE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+
+enum bus_trace_op {
+	BUS_TRACE_READ,
+	BUS_TRACE_WRITE,
+	BUS_TRACE_HL_READ,
+	BUS_TRACE_READV,
+	BUS_TRACE_WRITEV,
+	BUS_TRACE_RDSR1,
+	BUS_TRACE_RDSR2,
+	BUS_TRACE_WRSR2,
+};
+
+#define BUS_TRACE_MAGIC 0x5442374e /* "N7BT" */
+#define BUS_TRACE_VERSION 1
+
+/**
+ * struct bus_trace_hdr - Header of a dumped trace.
+ * @magic: BUS_TRACE_MAGIC.
+ * @version: BUS_TRACE_VERSION.
+ * @rec_size: Size of a record in bytes.
+ * @cycles_per_sec: Frequency of the timestamp and duration counter.
+ * @count: Number of records following the header, oldest first.
+ *
+ * The dump is the header followed by the records, in CPU byte order.
+ */
+struct bus_trace_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t rec_size;
+	uint32_t cycles_per_sec;
+	uint32_t count;
+};
+
+/**
+ * struct bus_trace_rec - Record of a bus transaction.
+ * @ts: Start of the transaction in cycles.
+ * @dur: Duration of the transaction in cycles.
+ * @addr: RPU address, first segment for vectored transfers.
+ * @len: Length in bytes, total of all segments for vectored transfers.
+ * @op: Transaction type, see enum bus_trace_op.
+ * @ret: Return code, clamped to the int8_t range.
+ */
+struct bus_trace_rec {
+	uint32_t ts;
+	uint32_t dur;
+	uint32_t addr;
+	uint16_t len;
+	uint8_t op;
+	int8_t ret;
+};
+
+#ifdef CONFIG_NRF700X_BUS_TRACE
+static inline uint32_t bus_trace_start(void)
+{
+	return k_cycle_get_32();
+}
+
+/*! \brief Record a bus transaction in the trace ring
+ *
+ *  Lock-free, the oldest record is overwritten once the ring is full.
+ *
+ *  \param op Transaction type
+ *  \param addr RPU address
+ *  \param len Length in bytes
+ *  \param ret Return code of the transaction
+ *  \param start Value returned by bus_trace_start() before the transaction
+ */
+void bus_trace_record(enum bus_trace_op op, uint32_t addr, uint32_t len, int ret,
+		      uint32_t start);
+
+/*! \brief Dump the trace ring
+ *
+ *  Records added while dumping may show up torn or be missed.
+ *
+ *  \param buf Destination buffer, NULL to get the size needed
+ *  \param size Size of buf in bytes
+ *  \return Number of bytes written, header and whole records only.
+ */
+size_t bus_trace_dump(void *buf, size_t size);
+
+/*! \brief Discard all records */
+void bus_trace_clear(void);
+#else
+static inline uint32_t bus_trace_start(void)
+{
+	return 0;
+}
+
+static inline void bus_trace_record(enum bus_trace_op op, uint32_t addr, uint32_t len, int ret,
+				    uint32_t start)
+{
+}
+#endif /* CONFIG_NRF700X_BUS_TRACE */
+
+#endif /* __BUS_TRACE_H__ */
@@ -17,11 +17,43 @@
 #ifdef CONFIG_NRF700X_ON_QSPI
 #include <nrfx_qspi.h>
 #endif
+#ifdef CONFIG_NRF700X_ON_SPI
+#include <zephyr/drivers/spi.h>
+#endif
 
 #define RPU_WAKEUP_NOW BIT(0) /* WAKEUP RPU - RW */
 #define RPU_AWAKE_BIT BIT(1) /* RPU AWAKE FROM SLEEP - RO */
 #define RPU_READY_BIT BIT(2) /* RPU IS READY - RO*/
 
+/* RPU wake up status polling: the delay between status reads starts at
+ * RPU_WAKE_POLL_MIN_US and doubles up to RPU_WAKE_POLL_MAX_US, polling
+ * gives up after RPU_WAKE_TIMEOUT_US. Delays below RPU_WAKE_POLL_SLEEP_US
+ * are busy waited as they are shorter than a reschedule.
+ */
+#define RPU_WAKE_POLL_MIN_US 10
+#define RPU_WAKE_POLL_MAX_US 1000
+#define RPU_WAKE_POLL_SLEEP_US 100
+#define RPU_WAKE_TIMEOUT_US 10000
+
+/* Bus clock used for waking up the RPU, works reliably on all boards */
+#define RPU_WAKE_FREQ MHZ(8)
+
+/* Wait before the next status read, returns the time waited in us */
+static inline uint32_t rpu_wake_poll_delay(uint32_t *delay_us)
+{
+	uint32_t us = *delay_us;
+
+	if (us < RPU_WAKE_POLL_SLEEP_US) {
+		k_busy_wait(us);
+	} else {
+		k_usleep(us);
+	}
+
+	*delay_us = MIN(us * 2, RPU_WAKE_POLL_MAX_US);
+
+	return us;
+}
+
 struct qspi_config {
 #ifdef CONFIG_NRF700X_ON_QSPI
 	nrf_qspi_addrmode_t addrmode;
@@ -52,14 +84,139 @@ struct qspi_config {
 	int test_status;
 	int test_iteration;
 };
+
+/**
+ * struct qspi_seg - One segment of a vectored (scatter-gather) transfer.
+ * @addr: RPU address of the segment.
+ * @data: Host buffer to read into or write from.
+ * @len: Length of the segment in bytes.
+ */
+struct qspi_seg {
+	unsigned int addr;
+	void *data;
+	int len;
+};
+
+/* Segments of a vectored transfer sorted in encrypted mode */
+#define QSPI_SEG_SORT_MAX 8
+
+/*! \brief Order the segments of a vectored transfer by RPU address
+ *
+ *  Adjacent segments then form contiguous runs that qspi_seg_run() can
+ *  merge. Writes are only reordered if no two segments overlap.
+ *
+ *  \param segs Segments of the transfer
+ *  \param count Number of segments
+ *  \param write Segments are written
+ *  \param order Filled with the segment indices, at least count entries
+ *  \return order, or NULL to keep the given order.
+ */
+const uint8_t *qspi_seg_order(const struct qspi_seg *segs, int count, bool write,
+			      uint8_t *order);
+
+static inline const struct qspi_seg *qspi_seg_at(const struct qspi_seg *segs,
+						 const uint8_t *order, int i)
+{
+	return order ? &segs[order[i]] : &segs[i];
+}
+
+/*! \brief Merge segments into a single transfer
+ *
+ *  Merges the segments from index i on that are contiguous both on the RPU
+ *  and in host memory. Only whole word segments are merged.
+ *
+ *  \param segs Segments of the transfer
+ *  \param order Order from qspi_seg_order(), NULL for the given order
+ *  \param i Index of the first segment of the run
+ *  \param count Number of segments
+ *  \param n Set to the number of segments merged
+ *  \return Length of the merged transfer in bytes.
+ */
+int qspi_seg_run(const struct qspi_seg *segs, const uint8_t *order, int i, int count, int *n);
+
+typedef int (*qspi_span_read_t)(void *ctx, unsigned int addr, void *buf, size_t len);
+
+/*! \brief Read an RPU span of any alignment through a bounce buffer
+ *
+ *  Reads the covering word-aligned span into the bounce buffer with one
+ *  call of read and copies out the requested bytes. Spans larger than the
+ *  bounce buffer are split.
+ *
+ *  \param addr RPU address
+ *  \param data Host buffer, of any alignment
+ *  \param size Length of the read in bytes
+ *  \param bounce Word-aligned bounce buffer
+ *  \param bounce_size Size of the bounce buffer, a multiple of 4
+ *  \param read Reads whole words at a word-aligned address, 0 on success
+ *  \param ctx Passed to read
+ *  \return 0 on success, otherwise the error returned by read.
+ */
+int qspi_span_read(unsigned int addr, void *data, size_t size, uint32_t *bounce,
+		   size_t bounce_size, qspi_span_read_t read, void *ctx);
+
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+struct qspi_async_xfer;
+
+typedef void (*qspi_async_cb_t)(struct qspi_async_xfer *xfer);
+
+/**
+ * struct qspi_async_xfer - Asynchronous (non-blocking) bus transfer.
+ * @addr: RPU address, must be word aligned.
+ * @data: Host buffer, must be word aligned and in RAM for QSPI EasyDMA.
+ * @len: Length of the transfer in bytes, must be a multiple of 4.
+ * @write: true to write @data to the RPU, false to read into @data.
+ * @cb: Optional completion callback, run from the system work queue.
+ * @user_data: Opaque pointer for use by @cb.
+ * @status: Result of the transfer, valid once it has completed.
+ *
+ * The bus stays locked from submission until completion, the remaining
+ * members are private to the bus layer.
+ */
+struct qspi_async_xfer {
+	unsigned int addr;
+	void *data;
+	int len;
+	bool write;
+	qspi_async_cb_t cb;
+	void *user_data;
+	int status;
+
+	struct k_work work;
+	struct k_sem done;
+	bool in_bus_txn;
+#ifdef CONFIG_NRF700X_ON_SPI
+	uint8_t hdr[5];
+	struct spi_buf tx_bufs[2];
+	struct spi_buf rx_bufs[2];
+	struct spi_buf_set tx;
+	struct spi_buf_set rx;
+#endif /* CONFIG_NRF700X_ON_SPI */
+};
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+
 struct qspi_dev {
 	int (*deinit)(void);
 	void *config;
 	int (*init)(struct qspi_config *config);
 	int (*write)(unsigned int addr, const void *data, int len);
 	int (*read)(unsigned int addr, void *data, int len);
-	int (*hl_read)(unsigned int addr, void *data, int len);
+	int (*hl_read)(unsigned int addr, void *data, int len, unsigned int latency);
+	int (*readv)(const struct qspi_seg *segs, int count);
+	int (*writev)(const struct qspi_seg *segs, int count);
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+	int (*submit)(struct qspi_async_xfer *xfer);
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+	int (*bus_begin)(void);
+	void (*bus_end)(void);
+	int (*set_freq)(uint32_t freq);
+	uint32_t (*get_freq)(void);
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+	void (*hl_burst_set)(bool enable);
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
 	void (*hard_reset)(void);
+#ifdef CONFIG_NRF700X_QSPI_XIP
+	int (*xip_read)(unsigned int addr, void *data, int len);
+#endif /* CONFIG_NRF700X_QSPI_XIP */
 };
 
 int qspi_cmd_wakeup_rpu(const struct device *dev, uint8_t data);
@@ -70,7 +227,101 @@ int qspi_write(unsigned int addr, const void *data, int len);
 
 int qspi_read(unsigned int addr, void *data, int len);
 
-int qspi_hl_read(unsigned int addr, void *data, int len);
+/*! \brief Read from a high-latency region of the RPU
+ *
+ *  \param addr Word aligned RPU address
+ *  \param data Destination buffer
+ *  \param len Length in bytes, multiple of 4
+ *  \param latency Slave latency in words of the region, see rpu_plan()
+ *  \return 0 on success, negative errno code on failure.
+ */
+int qspi_hl_read(unsigned int addr, void *data, int len, unsigned int latency);
+
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+/*! \brief Enable or disable the burst high-latency reads
+ *
+ *  Disabled at boot, high-latency reads are then done one word at a time
+ *  in fixed address mode. See rpu_hl_burst_verify().
+ *
+ *  \param enable Read several words per transaction
+ */
+void qspi_hl_burst_set(bool enable);
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+
+int qspi_readv(const struct qspi_seg *segs, int count);
+
+#ifdef CONFIG_NRF700X_QSPI_XIP
+/*! \brief Read RPU memory through the memory-mapped XIP window
+ *
+ *  Only valid for regions without slave latency, see rpu_addr_xip_capable().
+ *  Falls back to a DMA read when encryption is enabled.
+ *
+ *  \param addr Word aligned RPU address
+ *  \param data Destination buffer
+ *  \param len Length in bytes, multiple of 4
+ *  \return 0 on success, negative errno code on failure.
+ */
+int qspi_xip_read(unsigned int addr, void *data, int len);
+
+/*! \brief Copy RPU memory out of a mapped XIP window
+ *
+ *  Word loads only, the window does not support narrower accesses. Has no
+ *  peripheral dependency so the window can be backed by host memory in
+ *  tests.
+ *
+ *  \param window Address of RPU address 0 in the window
+ *  \param addr Word aligned RPU address
+ *  \param data Destination buffer, any alignment
+ *  \param len Length in bytes, multiple of 4
+ */
+void qspi_xip_copy(const volatile void *window, unsigned int addr, void *data, int len);
+#endif /* CONFIG_NRF700X_QSPI_XIP */
+
+int qspi_writev(const struct qspi_seg *segs, int count);
+
+/*! \brief Change the SCK frequency used for data transfers
+ *
+ *  The frequency is rounded down to the closest supported one. The RPU
+ *  wake up sequence still runs at the fixed wake up frequency.
+ *
+ *  \param freq Frequency in Hz
+ *  \return 0 on success, negative errno code on failure.
+ */
+int qspi_set_freq(uint32_t freq);
+
+/*! \brief Get the SCK frequency in use for data transfers, in Hz
+ *
+ *  This is the frequency produced by the divider chosen for the last
+ *  requested one, not the requested frequency itself.
+ */
+uint32_t qspi_get_freq(void);
+
+/*! \brief Start a bus transaction
+ *
+ *  Take the bus locks, and the peripheral in low power mode, once for a
+ *  sequence of operations. Until qspi_bus_end() the calling thread's
+ *  operations skip the per-op locking, other threads wait. Calls nest.
+ *  Asynchronous transfers submitted inside the bracket must complete
+ *  before it ends.
+ *
+ *  \return 0 on success, negative errno code on failure.
+ */
+int qspi_bus_begin(void);
+
+/*! \brief End a bus transaction started with qspi_bus_begin() */
+void qspi_bus_end(void);
+
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+int qspi_submit(struct qspi_async_xfer *xfer);
+
+/*! \brief Wait for an asynchronous transfer to complete
+ *
+ *  \param xfer Transfer previously accepted by the submit op
+ *  \param timeout Time to wait, K_NO_WAIT to poll
+ *  \return Status of the transfer, -EAGAIN if it is still in progress.
+ */
+int qspi_async_wait(struct qspi_async_xfer *xfer, k_timeout_t timeout);
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
 
 int qspi_deinit(void);
 
@@ -104,6 +355,61 @@ int func_rpu_wake(void);
 int func_rpu_sleep_status(void);
 #endif /* CONFIG_NRF_WIFI_LOW_POWER */
 
+/**
+ * struct qspi_lp_stats - QSPI low power statistics.
+ * @init_cnt: Number of times the peripheral was initialized.
+ * @uninit_cnt: Number of times the peripheral was uninitialized.
+ * @reuse_cnt: Number of accesses that found the peripheral already up.
+ *
+ * Only updated with CONFIG_NRF700X_QSPI_LOW_POWER, used to tune
+ * CONFIG_NRF700X_QSPI_IDLE_TIMEOUT_MS.
+ */
+struct qspi_lp_stats {
+	uint32_t init_cnt;
+	uint32_t uninit_cnt;
+	uint32_t reuse_cnt;
+};
+
+/*! \brief Get the QSPI peripheral init/uninit counters
+ *
+ *  \param stats Filled with a snapshot of the counters
+ */
+void qspi_lp_stats_get(struct qspi_lp_stats *stats);
+
+/**
+ * struct qspi_dma_stats - QSPI data transfer statistics.
+ * @zero_copy_bytes: Bytes moved by EasyDMA straight from/to the caller's
+ *                   buffer.
+ * @staged_bytes: Bytes copied through the DMA buffer pool because the
+ *                caller's buffer is outside RAM or not word aligned.
+ */
+struct qspi_dma_stats {
+	uint32_t zero_copy_bytes;
+	uint32_t staged_bytes;
+};
+
+/*! \brief Get the QSPI zero-copy/staged transfer counters
+ *
+ *  \param stats Filled with a snapshot of the counters
+ */
+void qspi_dma_stats_get(struct qspi_dma_stats *stats);
+
+/**
+ * struct qspi_nonce_stats - QSPI encryption nonce statistics.
+ * @transfers: Encrypted transfers, reads ([0]) and writes ([1]).
+ * @updates: Transfers that needed a nonce update, same indexes.
+ */
+struct qspi_nonce_stats {
+	uint32_t transfers[2];
+	uint32_t updates[2];
+};
+
+/*! \brief Get the QSPI encryption nonce update counters
+ *
+ *  \param stats Filled with a snapshot of the counters
+ */
+void qspi_nonce_stats_get(struct qspi_nonce_stats *stats);
+
 #define QSPI_KEY_LEN_BYTES 16
 
 /*! \brief Enable encryption
@@ -32,11 +32,168 @@ enum {
 };
 
 extern char blk_name[][15];
-extern uint32_t rpu_7002_memmap[][3];
+extern const uint32_t rpu_7002_memmap[][2];
 
+/**
+ * struct rpu_access - Access plan for the part of a transfer within one
+ * RPU memory block.
+ * @blk: Memory block, index in rpu_7002_memmap.
+ * @len: Bytes of the transfer within the block.
+ * @hl: Reads must use hl_read, the block is below PKTRAM.
+ * @latency: Slave latency in words of the high-latency reads, the
+ *           qspi_slave_latency of the bus at its current clock. 0 if
+ *           @hl is not set.
+ * @writable: Block can be written.
+ * @cacheable: Reads can be served from the shim read cache.
+ * @xip: Reads can use the QSPI XIP window (PKTRAM only).
+ */
+struct rpu_access {
+	int blk;
+	uint32_t len;
+	bool hl;
+	unsigned char latency;
+	bool writable;
+	bool cacheable;
+	bool xip;
+};
+
+/*! \brief Plan an access to RPU memory
+ *
+ *  Constant time lookup of the memory block holding addr. The shell and
+ *  the OS layer both choose the access type from the plan.
+ *
+ *  \param addr RPU address
+ *  \param len Length of the transfer in bytes
+ *  \param acc Filled with the plan for the leading part of the transfer
+ *              within the block of addr, acc->len may be less than len.
+ *  \return 0 on success, -EINVAL if addr is not mapped.
+ */
+int rpu_plan(uint32_t addr, uint32_t len, struct rpu_access *acc);
+
+struct qspi_dev;
+
+/*! \brief Select the bus device of rpu_read() and rpu_write()
+ *
+ *  Called by rpu_init() and rpu_disable(), or by a test with a simulated
+ *  bus device.
+ *
+ *  \param dev Bus device, NULL once the RPU is disabled
+ */
+void rpu_access_init(const struct qspi_dev *dev);
 int rpu_read(unsigned int addr, void *data, int len);
+#ifdef CONFIG_NRF700X_READ_CACHE
+bool rpu_addr_cacheable(uint32_t addr, uint32_t len);
+#endif /* CONFIG_NRF700X_READ_CACHE */
+#ifdef CONFIG_NRF700X_QSPI_XIP
+bool rpu_addr_xip_capable(uint32_t addr, uint32_t len);
+#endif /* CONFIG_NRF700X_QSPI_XIP */
 int rpu_write(unsigned int addr, const void *data, int len);
 
+/**
+ * struct rpu_bus_cal - Result of the bus calibration.
+ * @freq: Fastest reliable SCK frequency in Hz.
+ * @latency: Smallest slave latency (in words) at which high-latency
+ *           reads passed at @freq.
+ * @valid: Calibration completed successfully.
+ */
+struct rpu_bus_cal {
+	uint32_t freq;
+	unsigned char latency;
+	bool valid;
+};
+
+#ifdef CONFIG_NRF700X_BUS_CALIBRATE
+/*! \brief Find the fastest reliable bus clock and its slave latency
+ *
+ *  Searches the bus frequencies and, at each one, the slave latencies of
+ *  the high-latency reads, with test patterns written to PKTRAM and GRAM.
+ *  The scratch words are restored afterwards. The calibrated latency holds
+ *  until the next bus frequency change.
+ *
+ *  \return 0 on success, negative errno code on failure.
+ */
+int rpu_bus_calibrate(void);
+int rpu_bus_cal_get(struct rpu_bus_cal *cal);
+#endif /* CONFIG_NRF700X_BUS_CALIBRATE */
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+/*! \brief Enable the burst high-latency reads if they read back correctly
+ *
+ *  Writes test patterns to GRAM and reads them back in one burst, then
+ *  restores the GRAM words. The firmware must not use the bus meanwhile.
+ *  On failure the bursts stay disabled.
+ *
+ *  \return 0 if the bursts are enabled, negative errno code otherwise.
+ */
+int rpu_hl_burst_verify(void);
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+/* Raw bus bandwidth in bits per second */
+uint32_t rpu_bus_bandwidth_get(void);
+
+/**
+ * struct rpu_bus_bench_result - Result of one benchmark point.
+ * @write: Write (true) or read (false) transfers.
+ * @path: "rpu" (rpu_read/rpu_write), "bracket" (rpu_read/rpu_write
+ *        between rpu_bus_begin() and rpu_bus_end()), "direct" (read/write
+ *        op), "static" (read/write backend functions called directly,
+ *        NRF700X_BUS_STATIC_DISPATCH), "hl" (hl_read op, one word per
+ *        transaction) or "hl_burst" (hl_read op with burst reads,
+ *        NRF700X_HL_READ_BURST).
+ * @region: Name of the RPU memory block.
+ * @size: Transfer size in bytes.
+ * @align: Host buffer offset from a word boundary.
+ * @bytes_per_sec: Throughput.
+ * @xfers_per_sec: Transfers per second.
+ * @p50_ns: Median transfer latency.
+ * @p99_ns: 99th percentile transfer latency.
+ */
+struct rpu_bus_bench_result {
+	bool write;
+	const char *path;
+	const char *region;
+	uint32_t size;
+	uint32_t align;
+	uint32_t bytes_per_sec;
+	uint32_t xfers_per_sec;
+	uint32_t p50_ns;
+	uint32_t p99_ns;
+};
+
+typedef void (*rpu_bus_bench_cb_t)(const struct rpu_bus_bench_result *res, void *ctx);
+
+#ifdef CONFIG_NRF700X_BUS_BENCH
+/*! \brief Benchmark the bus over the RPU RAM blocks
+ *
+ *  Overwrites RPU RAM, only run it with the RPU enabled and before the
+ *  firmware is loaded.
+ *
+ *  \param cb Called with the result of each benchmark point
+ *  \param ctx Passed to cb
+ *  \return 0 on success, error code of the first failing transfer otherwise.
+ */
+int rpu_bus_bench_run(rpu_bus_bench_cb_t cb, void *ctx);
+#endif /* CONFIG_NRF700X_BUS_BENCH */
+#define RPU_WAKE_HIST_BUCKETS 16
+
+/**
+ * struct rpu_wake_stats - RPU wake up latency statistics.
+ * @count: Number of successful wake ups.
+ * @fail: Number of failed wake ups.
+ * @max_us: Longest wake up, from before the WRSR2 wake request to
+ *          RPU_AWAKE.
+ * @hist: Wake up latency histogram, bucket n counts wake ups that took
+ *        [2^n, 2^(n+1)) us and the last bucket everything longer.
+ */
+struct rpu_wake_stats {
+	uint32_t count;
+	uint32_t fail;
+	uint32_t max_us;
+	uint32_t hist[RPU_WAKE_HIST_BUCKETS];
+};
+
+void rpu_wake_stats_get(struct rpu_wake_stats *stats);
+void rpu_wake_stats_reset(void);
+int rpu_bus_begin(void);
+void rpu_bus_end(void);
 int rpu_sleep(void);
 int rpu_wakeup(void);
 int rpu_sleep_status(void);
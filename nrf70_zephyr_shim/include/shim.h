@@ -55,6 +55,129 @@ struct zep_shim_llist {
 	unsigned int len;
 };
 
+/**
+ * struct zep_shim_pw_stats - Posted write statistics.
+ * @posted: Number of writes posted.
+ * @combined: Number of posted writes combined with a pending run.
+ * @flushes: Number of bus writes issued to flush the posted writes.
+ * @errors: Number of those bus writes that failed.
+ */
+struct zep_shim_pw_stats {
+	uint32_t posted;
+	uint32_t combined;
+	uint32_t flushes;
+	uint32_t errors;
+};
+
+#ifdef CONFIG_NRF700X_POSTED_WRITES
+void zep_shim_pw_stats_get(struct zep_shim_pw_stats *stats);
+#endif /* CONFIG_NRF700X_POSTED_WRITES */
+
+/**
+ * struct zep_shim_rc_stats - Read cache statistics.
+ * @hits: Number of cache lines served from the cache.
+ * @misses: Number of cache lines read from the bus.
+ */
+struct zep_shim_rc_stats {
+	uint32_t hits;
+	uint32_t misses;
+};
+
+#ifdef CONFIG_NRF700X_READ_CACHE
+void zep_shim_rc_stats_get(struct zep_shim_rc_stats *stats);
+
+/*! \brief Invalidate the read cache lines overlapping a range
+ *
+ *  Needed by every write to RPU memory that bypasses the OS layer.
+ */
+void zep_shim_rc_invalidate(unsigned long addr, size_t count);
+#endif /* CONFIG_NRF700X_READ_CACHE */
+
+#define ZEP_SHIM_SLAB_CLASSES 4
+
+/**
+ * struct zep_shim_slab_stats - Memory slab size class statistics.
+ * @size: Block size of the class in bytes.
+ * @blocks: Number of blocks of the class.
+ * @used: Number of blocks currently allocated.
+ * @peak: Highest number of blocks allocated at the same time.
+ * @allocs: Number of allocations served by the class.
+ * @exhausted: Number of allocations of the class which found no free
+ *             block and were served by the heap.
+ */
+struct zep_shim_slab_stats {
+	uint32_t size;
+	uint32_t blocks;
+	uint32_t used;
+	uint32_t peak;
+	uint32_t allocs;
+	uint32_t exhausted;
+};
+
+#ifdef CONFIG_NRF700X_MEM_SLAB
+/*! \brief Get the memory slab statistics
+ *
+ *  \param stats Array of ZEP_SHIM_SLAB_CLASSES entries, smallest class first
+ *  \param large Number of allocations larger than the largest class
+ */
+void zep_shim_slab_stats_get(struct zep_shim_slab_stats *stats, uint32_t *large);
+#endif /* CONFIG_NRF700X_MEM_SLAB */
+
+#define ZEP_SHIM_NBUF_POOLS 2
+
+/**
+ * struct zep_shim_nbuf_pool_stats - Network buffer pool statistics.
+ * @size: Largest data size served by the pool in bytes.
+ * @blocks: Number of buffers in the pool.
+ * @used: Number of buffers currently allocated.
+ * @allocs: Number of buffers allocated from the pool.
+ * @exhausted: Number of allocations which found the pool empty.
+ */
+struct zep_shim_nbuf_pool_stats {
+	uint32_t size;
+	uint32_t blocks;
+	uint32_t used;
+	uint32_t allocs;
+	uint32_t exhausted;
+};
+
+/**
+ * struct zep_shim_nbuf_stats - Network buffer statistics.
+ * @pool: Per pool statistics, smallest pool first.
+ * @heap: Number of buffers allocated from the heap.
+ * @frees: Number of buffers freed.
+ * @alloc_cycles: Total CPU cycles spent allocating buffers.
+ * @free_cycles: Total CPU cycles spent freeing buffers.
+ */
+struct zep_shim_nbuf_stats {
+	struct zep_shim_nbuf_pool_stats pool[ZEP_SHIM_NBUF_POOLS];
+	uint32_t heap;
+	uint32_t frees;
+	uint64_t alloc_cycles;
+	uint64_t free_cycles;
+};
+
+#ifdef CONFIG_NRF700X_NBUF_POOL
+void zep_shim_nbuf_stats_get(struct zep_shim_nbuf_stats *stats);
+#endif /* CONFIG_NRF700X_NBUF_POOL */
+
+/**
+ * struct zep_shim_rx_stats - RX path statistics, each frame is counted once.
+ * @zero_copy: Number of frames handed over by attaching the buffer data.
+ * @copied: Number of frames copied, as their buffer was no network
+ *          buffer fragment.
+ * @drops: Number of frames dropped for lack of network packets.
+ */
+struct zep_shim_rx_stats {
+	uint32_t zero_copy;
+	uint32_t copied;
+	uint32_t drops;
+};
+
+#ifdef CONFIG_NRF700X_ZERO_COPY_RX
+void zep_shim_rx_stats_get(struct zep_shim_rx_stats *stats);
+#endif /* CONFIG_NRF700X_ZERO_COPY_RX */
+
 void *net_pkt_to_nbuf(struct net_pkt *pkt);
 void *net_pkt_from_nbuf(void *iface, void *frm);
 #if defined(CONFIG_NRF700X_RAW_DATA_RX) || defined(CONFIG_NRF700X_PROMISC_DATA_RX)
@@ -19,7 +19,27 @@ int spim_write(unsigned int addr, const void *data, int len);
 
 int spim_read(unsigned int addr, void *data, int len);
 
-int spim_hl_read(unsigned int addr, void *data, int len);
+int spim_hl_read(unsigned int addr, void *data, int len, unsigned int latency);
+
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+void spim_hl_burst_set(bool enable);
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+
+int spim_readv(const struct qspi_seg *segs, int count);
+
+int spim_writev(const struct qspi_seg *segs, int count);
+
+int spim_set_freq(uint32_t freq);
+
+uint32_t spim_get_freq(void);
+
+int spim_bus_begin(void);
+
+void spim_bus_end(void);
+
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+int spim_submit(struct qspi_async_xfer *xfer);
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
 
 int spim_cmd_rpu_wakeup_fn(uint32_t data);
 
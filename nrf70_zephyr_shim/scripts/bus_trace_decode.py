@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2024 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+"""Decode an nRF70 bus trace dump into a timeline and a per-region summary.
+
+The input is either the binary output of bus_trace_dump() or a capture of
+the "nrf70_bus_trace dump" shell command (one hex line per header/record,
+other lines are ignored).
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = 0x5442374E
+HDR = struct.Struct("<IHHII")
+REC = struct.Struct("<IIIHBb")
+
+OPS = ["read", "write", "hl_read", "readv", "writev", "rdsr1", "rdsr2", "wrsr2"]
+CMD_OPS = {"rdsr1", "rdsr2", "wrsr2"}
+
+# Same blocks as rpu_7002_memmap in rpu_hw_if.c
+REGIONS = [
+    ("SysBus", 0x000000, 0x008FFF),
+    ("ExtSysBus", 0x009000, 0x03FFFF),
+    ("PBus", 0x040000, 0x07FFFF),
+    ("PKTRAM", 0x0C0000, 0x0F0FFF),
+    ("GRAM", 0x080000, 0x092000),
+    ("LMAC_ROM", 0x100000, 0x134000),
+    ("LMAC_RET_RAM", 0x140000, 0x14C000),
+    ("LMAC_SRC_RAM", 0x180000, 0x190000),
+    ("UMAC_ROM", 0x200000, 0x261800),
+    ("UMAC_RET_RAM", 0x280000, 0x2A4000),
+    ("UMAC_SRC_RAM", 0x300000, 0x338000),
+]
+
+HEX_LINE = re.compile(r"^\s*([0-9a-fA-F]{32})\s*$")
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if len(data) >= 4 and struct.unpack_from("<I", data)[0] == MAGIC:
+        return data
+
+    lines = data.decode(errors="ignore").splitlines()
+    return b"".join(bytes.fromhex(m.group(1)) for m in map(HEX_LINE.match, lines) if m)
+
+
+def region(op, addr):
+    if op in CMD_OPS:
+        return "CMD"
+
+    # Drop the incremental address mode bit
+    addr &= 0x7FFFFF
+
+    for name, start, end in REGIONS:
+        if start <= addr <= end:
+            return name
+
+    return "unknown"
+
+
+def decode(data):
+    magic, version, rec_size, cps, count = HDR.unpack_from(data)
+
+    if magic != MAGIC:
+        sys.exit("not a bus trace dump")
+
+    if version != 1 or rec_size != REC.size:
+        sys.exit(f"unsupported trace version {version}, record size {rec_size}")
+
+    recs = []
+    for i in range(count):
+        off = HDR.size + i * rec_size
+        if off + rec_size > len(data):
+            break
+        ts, dur, addr, length, op, ret = REC.unpack_from(data, off)
+        name = OPS[op] if op < len(OPS) else f"op{op}"
+        recs.append((ts, dur, addr, length, name, ret))
+
+    return cps, recs
+
+
+def timeline(cps, recs):
+    t0 = recs[0][0] if recs else 0
+
+    print(f"{'time_us':>12} {'dur_us':>9} {'op':<8} {'region':<13} {'addr':>8} {'len':>6} ret")
+    for ts, dur, addr, length, op, ret in recs:
+        # Timestamps are 32-bit cycle counts, unwrap relative to the first
+        t = ((ts - t0) & 0xFFFFFFFF) * 1e6 / cps
+        print(f"{t:12.1f} {dur * 1e6 / cps:9.1f} {op:<8} {region(op, addr):<13} "
+              f"{addr & 0x7FFFFF:08x} {length:6d} {ret}")
+
+
+def summary(cps, recs):
+    stats = {}
+
+    for _, dur, addr, length, op, ret in recs:
+        s = stats.setdefault(region(op, addr), [0, 0, 0, 0])
+        s[0] += 1
+        s[1] += length
+        s[2] += dur
+        s[3] += ret != 0
+
+    print(f"{'region':<13} {'count':>7} {'bytes':>10} {'busy_ms':>9} {'MB/s':>7} {'errors':>6}")
+    for name, (count, nbytes, cycles, errors) in sorted(stats.items()):
+        busy = cycles / cps
+        rate = nbytes / busy / 1e6 if busy else 0.0
+        print(f"{name:<13} {count:7d} {nbytes:10d} {busy * 1e3:9.2f} {rate:7.2f} {errors:6d}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="binary dump or shell capture")
+    parser.add_argument("--no-timeline", action="store_true", help="only print the summary")
+    args = parser.parse_args()
+
+    cps, recs = decode(load(args.dump))
+
+    if not args.no_timeline:
+        timeline(cps, recs)
+        print()
+
+    summary(cps, recs)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the bus owner thread for the Zephyr OS layer of
+ * the Wi-Fi driver. A single thread executes all data transfers queued by
+ * the other threads, small reads are served ahead of bulk transfers.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/mpsc_lockfree.h>
+
+#include "qspi_if.h"
+#include "bus_owner.h"
+
+LOG_MODULE_DECLARE(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
+
+BUILD_ASSERT((CONFIG_NRF700X_BUS_OWNER_CHUNK_SIZE % 4) == 0,
+	     "Bus owner chunk size must be a multiple of 4");
+
+enum bus_req_op {
+	BUS_REQ_READ,
+	BUS_REQ_WRITE,
+	BUS_REQ_HL_READ,
+	BUS_REQ_READV,
+	BUS_REQ_WRITEV,
+};
+
+enum bus_req_prio {
+	BUS_PRIO_HIGH,
+	BUS_PRIO_NORMAL,
+	BUS_PRIO_NUM,
+};
+
+/**
+ * struct bus_req - Request queued to the bus owner thread.
+ * @node: Queue node.
+ * @op: Operation to execute.
+ * @addr: RPU address (read/write/hl_read).
+ * @data: Data buffer (read/write/hl_read).
+ * @len: Length in bytes (read/write/hl_read).
+ * @latency: Slave latency in words (hl_read).
+ * @segs: Segments (readv/writev).
+ * @count: Number of segments (readv/writev).
+ * @status: Result of the operation.
+ * @done: Given by the owner thread once the request is executed.
+ *
+ * Requests live on the stack of the waiting caller.
+ */
+struct bus_req {
+	struct mpsc_node node;
+	enum bus_req_op op;
+	unsigned int addr;
+	void *data;
+	int len;
+	unsigned int latency;
+	const struct qspi_seg *segs;
+	int count;
+	int status;
+	struct k_sem done;
+};
+
+K_THREAD_STACK_DEFINE(bus_owner_stack_area, CONFIG_NRF700X_BUS_OWNER_STACK_SIZE);
+
+static struct k_thread bus_owner_thread_data;
+static struct qspi_dev *bus_dev;
+static struct qspi_dev bus_owner_qdev;
+static struct mpsc bus_owner_q[BUS_PRIO_NUM];
+static K_SEM_DEFINE(bus_owner_sem, 0, K_SEM_MAX_LIMIT);
+static K_MUTEX_DEFINE(bus_owner_dev_lock);
+
+/* Counted from the callers and the owner thread, see bus_owner_stats */
+static atomic_t bus_owner_high;
+static atomic_t bus_owner_normal;
+static atomic_t bus_owner_preempt;
+static atomic_t bus_owner_direct;
+
+/* Thread holding the bus through bus_begin, its requests bypass the queue
+ * as the owner thread would block on the locks it holds. Read by every
+ * caller, the depth is only used by the holder.
+ */
+static atomic_ptr_t bus_owner_bracket_tid;
+static int bus_owner_bracket_depth;
+
+static int bus_req_exec(struct bus_req *req, unsigned int off, int len)
+{
+	switch (req->op) {
+	case BUS_REQ_READ:
+		return bus_dev->read(req->addr + off, (uint8_t *)req->data + off, len);
+	case BUS_REQ_WRITE:
+		return bus_dev->write(req->addr + off, (uint8_t *)req->data + off, len);
+	case BUS_REQ_HL_READ:
+		return bus_dev->hl_read(req->addr, req->data, req->len, req->latency);
+	case BUS_REQ_READV:
+		return bus_dev->readv(req->segs, req->count);
+	case BUS_REQ_WRITEV:
+		return bus_dev->writev(req->segs, req->count);
+	default:
+		return -EINVAL;
+	}
+}
+
+static void bus_req_complete(struct bus_req *req, int status)
+{
+	req->status = status;
+
+	/* Last access to req, the caller returns once woken up */
+	k_sem_give(&req->done);
+}
+
+static struct bus_req *bus_owner_pop(enum bus_req_prio prio)
+{
+	struct mpsc_node *node = mpsc_pop(&bus_owner_q[prio]);
+
+	return node ? CONTAINER_OF(node, struct bus_req, node) : NULL;
+}
+
+static int bus_owner_serve_high(void)
+{
+	struct bus_req *req;
+	int served = 0;
+
+	while ((req = bus_owner_pop(BUS_PRIO_HIGH)) != NULL) {
+		atomic_inc(&bus_owner_high);
+		bus_req_complete(req, bus_req_exec(req, 0, req->len));
+		served++;
+	}
+
+	return served;
+}
+
+/* Bulk reads and writes are split in chunks, high priority requests are
+ * served in between so that they wait for at most one chunk. The owner
+ * thread holds the bus across the chunks, a thread bracketing its accesses
+ * with bus_begin cannot run between them.
+ */
+static void bus_owner_serve_normal(struct bus_req *req)
+{
+	int status;
+	int off;
+	int len;
+
+	atomic_inc(&bus_owner_normal);
+
+	if (((req->op != BUS_REQ_READ) && (req->op != BUS_REQ_WRITE)) ||
+	    (req->len <= CONFIG_NRF700X_BUS_OWNER_CHUNK_SIZE)) {
+		bus_req_complete(req, bus_req_exec(req, 0, req->len));
+		return;
+	}
+
+	status = bus_dev->bus_begin();
+	if (status) {
+		bus_req_complete(req, status);
+		return;
+	}
+
+	for (off = 0; (off < req->len) && !status; off += len) {
+		len = MIN(req->len - off, CONFIG_NRF700X_BUS_OWNER_CHUNK_SIZE);
+
+		if (off && bus_owner_serve_high()) {
+			atomic_inc(&bus_owner_preempt);
+		}
+
+		status = bus_req_exec(req, off, len);
+	}
+
+	bus_dev->bus_end();
+
+	bus_req_complete(req, status);
+}
+
+static void bus_owner_thread(void *p1, void *p2, void *p3)
+{
+	struct bus_req *req;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&bus_owner_sem, K_FOREVER);
+
+		bus_owner_serve_high();
+
+		req = bus_owner_pop(BUS_PRIO_NORMAL);
+		if (req) {
+			bus_owner_serve_normal(req);
+		}
+	}
+}
+
+static inline bool bus_owner_bypass(void)
+{
+	k_tid_t tid = k_current_get();
+
+	return (tid == atomic_ptr_get(&bus_owner_bracket_tid)) || (tid == &bus_owner_thread_data);
+}
+
+static int bus_owner_call(struct bus_req *req, enum bus_req_prio prio)
+{
+	k_sem_init(&req->done, 0, 1);
+
+	mpsc_push(&bus_owner_q[prio], &req->node);
+	k_sem_give(&bus_owner_sem);
+
+	k_sem_take(&req->done, K_FOREVER);
+
+	return req->status;
+}
+
+static inline enum bus_req_prio bus_read_prio(int len)
+{
+	return (len <= CONFIG_NRF700X_BUS_OWNER_SMALL_READ) ? BUS_PRIO_HIGH : BUS_PRIO_NORMAL;
+}
+
+static int bus_owner_read(unsigned int addr, void *data, int len)
+{
+	struct bus_req req = { .op = BUS_REQ_READ, .addr = addr, .data = data, .len = len };
+
+	if (bus_owner_bypass()) {
+		atomic_inc(&bus_owner_direct);
+		return bus_dev->read(addr, data, len);
+	}
+
+	return bus_owner_call(&req, bus_read_prio(len));
+}
+
+static int bus_owner_write(unsigned int addr, const void *data, int len)
+{
+	struct bus_req req = {
+		.op = BUS_REQ_WRITE,
+		.addr = addr,
+		.data = (void *)data,
+		.len = len
+	};
+
+	if (bus_owner_bypass()) {
+		atomic_inc(&bus_owner_direct);
+		return bus_dev->write(addr, data, len);
+	}
+
+	return bus_owner_call(&req, BUS_PRIO_NORMAL);
+}
+
+static int bus_owner_hl_read(unsigned int addr, void *data, int len, unsigned int latency)
+{
+	struct bus_req req = {
+		.op = BUS_REQ_HL_READ,
+		.addr = addr,
+		.data = data,
+		.len = len,
+		.latency = latency
+	};
+
+	if (bus_owner_bypass()) {
+		atomic_inc(&bus_owner_direct);
+		return bus_dev->hl_read(addr, data, len, latency);
+	}
+
+	/* Register and event header reads, always latency sensitive */
+	return bus_owner_call(&req, BUS_PRIO_HIGH);
+}
+
+static int bus_owner_readv(const struct qspi_seg *segs, int count)
+{
+	struct bus_req req = { .op = BUS_REQ_READV, .segs = segs, .count = count };
+	int len = 0;
+	int i;
+
+	if (bus_owner_bypass()) {
+		atomic_inc(&bus_owner_direct);
+		return bus_dev->readv(segs, count);
+	}
+
+	for (i = 0; i < count; i++) {
+		len += segs[i].len;
+	}
+
+	return bus_owner_call(&req, bus_read_prio(len));
+}
+
+static int bus_owner_writev(const struct qspi_seg *segs, int count)
+{
+	struct bus_req req = { .op = BUS_REQ_WRITEV, .segs = segs, .count = count };
+
+	if (bus_owner_bypass()) {
+		atomic_inc(&bus_owner_direct);
+		return bus_dev->writev(segs, count);
+	}
+
+	return bus_owner_call(&req, BUS_PRIO_NORMAL);
+}
+
+static int bus_owner_bus_begin(void)
+{
+	int ret = bus_dev->bus_begin();
+
+	if (ret) {
+		return ret;
+	}
+
+	atomic_ptr_set(&bus_owner_bracket_tid, k_current_get());
+	bus_owner_bracket_depth++;
+
+	return 0;
+}
+
+static void bus_owner_bus_end(void)
+{
+	if ((atomic_ptr_get(&bus_owner_bracket_tid) == k_current_get()) &&
+	    (--bus_owner_bracket_depth == 0)) {
+		atomic_ptr_set(&bus_owner_bracket_tid, NULL);
+	}
+
+	bus_dev->bus_end();
+}
+
+struct qspi_dev *bus_owner_dev(struct qspi_dev *bus)
+{
+	k_mutex_lock(&bus_owner_dev_lock, K_FOREVER);
+
+	if (!bus_dev) {
+		/* Commands and asynchronous transfers go to the bus directly */
+		bus_owner_qdev = *bus;
+		bus_owner_qdev.read = bus_owner_read;
+		bus_owner_qdev.write = bus_owner_write;
+		bus_owner_qdev.hl_read = bus_owner_hl_read;
+		bus_owner_qdev.readv = bus_owner_readv;
+		bus_owner_qdev.writev = bus_owner_writev;
+		bus_owner_qdev.bus_begin = bus_owner_bus_begin;
+		bus_owner_qdev.bus_end = bus_owner_bus_end;
+
+		bus_dev = bus;
+	}
+
+	k_mutex_unlock(&bus_owner_dev_lock);
+
+	return &bus_owner_qdev;
+}
+
+/* Nothing is queued before bus_owner_dev() hands out the device, the
+ * thread sleeps until then.
+ */
+static int bus_owner_init(void)
+{
+	k_tid_t tid;
+	int i;
+
+	for (i = 0; i < BUS_PRIO_NUM; i++) {
+		mpsc_init(&bus_owner_q[i]);
+	}
+
+	tid = k_thread_create(&bus_owner_thread_data, bus_owner_stack_area,
+			      K_THREAD_STACK_SIZEOF(bus_owner_stack_area),
+			      bus_owner_thread, NULL, NULL, NULL,
+			      CONFIG_NRF700X_BUS_OWNER_PRIORITY, 0, K_NO_WAIT);
+
+	k_thread_name_set(tid, "nrf70_bus");
+
+	return 0;
+}
+
+void bus_owner_stats_get(struct bus_owner_stats *stats)
+{
+	stats->high = atomic_get(&bus_owner_high);
+	stats->normal = atomic_get(&bus_owner_normal);
+	stats->preempt = atomic_get(&bus_owner_preempt);
+	stats->direct = atomic_get(&bus_owner_direct);
+}
+
+SYS_INIT(bus_owner_init, POST_KERNEL, 0);
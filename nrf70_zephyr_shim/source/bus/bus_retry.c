@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the bus error policy for the Zephyr OS layer of
+ * the Wi-Fi driver. Failed data transfers are retried with an exponential
+ * backoff, repeated failures optionally lower the bus clock.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "qspi_if.h"
+#include "bus_retry.h"
+
+LOG_MODULE_DECLARE(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
+
+/* Backoff delays below this are busy waits */
+#define BUS_RETRY_SLEEP_US 100
+
+/* The SysBus, ExtSysBus and PBus register spaces, below GRAM, hold FIFOs
+ * and event registers whose accesses have side effects. A failed access
+ * may still have reached the RPU, so it is not repeated.
+ */
+#define BUS_RETRY_REG_ADDR_END 0x080000
+
+/**
+ * struct bus_retry_xfer - Arguments of a data transfer.
+ * @op: Operation.
+ * @addr: RPU address (read/write/hl_read).
+ * @data: Data buffer (read/write/hl_read).
+ * @len: Length in bytes (read/write/hl_read).
+ * @latency: Slave latency in words (hl_read).
+ * @segs: Segments (readv/writev).
+ * @count: Number of segments (readv/writev).
+ */
+struct bus_retry_xfer {
+	enum bus_retry_op op;
+	unsigned int addr;
+	void *data;
+	int len;
+	unsigned int latency;
+	const struct qspi_seg *segs;
+	int count;
+};
+
+static struct qspi_dev *bus_dev;
+static struct qspi_dev bus_retry_qdev;
+
+/* Protects the statistics, the streak and the clock drop */
+static struct k_spinlock bus_retry_lock;
+static struct bus_err_stats bus_err_stats;
+
+/* Consecutive transfers that needed a retry */
+static unsigned int bus_retry_streak;
+static bool bus_retry_slowed;
+
+static bool bus_retry_allowed(const struct bus_retry_xfer *xfer)
+{
+	int i;
+
+	switch (xfer->op) {
+	case BUS_RETRY_READV:
+	case BUS_RETRY_WRITEV:
+		for (i = 0; i < xfer->count; i++) {
+			if (xfer->segs[i].addr < BUS_RETRY_REG_ADDR_END) {
+				return false;
+			}
+		}
+
+		return true;
+	default:
+		return xfer->addr >= BUS_RETRY_REG_ADDR_END;
+	}
+}
+
+static int bus_retry_exec(const struct bus_retry_xfer *xfer)
+{
+	switch (xfer->op) {
+	case BUS_RETRY_READ:
+		return bus_dev->read(xfer->addr, xfer->data, xfer->len);
+	case BUS_RETRY_WRITE:
+		return bus_dev->write(xfer->addr, xfer->data, xfer->len);
+	case BUS_RETRY_HL_READ:
+		return bus_dev->hl_read(xfer->addr, xfer->data, xfer->len, xfer->latency);
+	case BUS_RETRY_READV:
+		return bus_dev->readv(xfer->segs, xfer->count);
+	case BUS_RETRY_WRITEV:
+		return bus_dev->writev(xfer->segs, xfer->count);
+	default:
+		return -EINVAL;
+	}
+}
+
+static void bus_retry_delay(uint32_t *delay_us)
+{
+	uint32_t us = *delay_us;
+
+	if (us < BUS_RETRY_SLEEP_US) {
+		k_busy_wait(us);
+	} else {
+		k_usleep(us);
+	}
+
+	*delay_us = MIN(us * 2, CONFIG_NRF700X_BUS_RETRY_BACKOFF_MAX_US);
+}
+
+/* The wake up frequency is the one the RPU is known to work at. The burst
+ * high-latency reads were only verified at the previous clock, they are
+ * turned off. The slave latencies are counted in words and hold at any
+ * clock.
+ */
+static void bus_retry_slow_down(void)
+{
+	k_spinlock_key_t key;
+	bool lowered = false;
+
+	if (bus_dev->get_freq() > RPU_WAKE_FREQ) {
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+		bus_dev->hl_burst_set(false);
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+		lowered = !bus_dev->set_freq(RPU_WAKE_FREQ);
+	}
+
+	key = k_spin_lock(&bus_retry_lock);
+
+	if (lowered) {
+		bus_err_stats.clock_drops++;
+	}
+
+	bus_retry_streak = 0;
+	bus_retry_slowed = false;
+
+	k_spin_unlock(&bus_retry_lock, key);
+
+	if (lowered) {
+		LOG_WRN("Repeated bus errors, bus clock lowered to %d Hz", RPU_WAKE_FREQ);
+	}
+}
+
+static int bus_retry_run(const struct bus_retry_xfer *xfer)
+{
+	uint32_t delay_us = CONFIG_NRF700X_BUS_RETRY_BACKOFF_US;
+	int max = bus_retry_allowed(xfer) ? CONFIG_NRF700X_BUS_RETRY_MAX : 0;
+	k_spinlock_key_t key;
+	bool slow_down = false;
+	int retries = 0;
+	int ret;
+
+	while ((ret = bus_retry_exec(xfer)) != 0) {
+		key = k_spin_lock(&bus_retry_lock);
+		bus_err_stats.errors[xfer->op]++;
+		k_spin_unlock(&bus_retry_lock, key);
+
+		/* Invalid arguments fail the same way every time */
+		if ((ret == -EINVAL) || (retries == max)) {
+			break;
+		}
+
+		bus_retry_delay(&delay_us);
+		retries++;
+	}
+
+	key = k_spin_lock(&bus_retry_lock);
+
+	if (!ret && !retries) {
+		bus_retry_streak = 0;
+		k_spin_unlock(&bus_retry_lock, key);
+		return 0;
+	}
+
+	if (ret) {
+		bus_err_stats.failed++;
+	} else {
+		bus_err_stats.recovered++;
+	}
+
+	bus_retry_streak++;
+
+	/* A single caller lowers the clock */
+	if (CONFIG_NRF700X_BUS_RETRY_SLOW_CLOCK_AFTER && !bus_retry_slowed &&
+	    (bus_retry_streak >= CONFIG_NRF700X_BUS_RETRY_SLOW_CLOCK_AFTER)) {
+		bus_retry_slowed = true;
+		slow_down = true;
+	}
+
+	k_spin_unlock(&bus_retry_lock, key);
+
+	if (ret) {
+		LOG_ERR("Bus op %d failed after %d retries: %d", xfer->op, retries, ret);
+	}
+
+	if (slow_down) {
+		bus_retry_slow_down();
+	}
+
+	return ret;
+}
+
+static int bus_retry_read(unsigned int addr, void *data, int len)
+{
+	struct bus_retry_xfer xfer = {
+		.op = BUS_RETRY_READ,
+		.addr = addr,
+		.data = data,
+		.len = len
+	};
+
+	return bus_retry_run(&xfer);
+}
+
+static int bus_retry_write(unsigned int addr, const void *data, int len)
+{
+	struct bus_retry_xfer xfer = {
+		.op = BUS_RETRY_WRITE,
+		.addr = addr,
+		.data = (void *)data,
+		.len = len
+	};
+
+	return bus_retry_run(&xfer);
+}
+
+static int bus_retry_hl_read(unsigned int addr, void *data, int len, unsigned int latency)
+{
+	struct bus_retry_xfer xfer = {
+		.op = BUS_RETRY_HL_READ,
+		.addr = addr,
+		.data = data,
+		.len = len,
+		.latency = latency
+	};
+
+	return bus_retry_run(&xfer);
+}
+
+static int bus_retry_readv(const struct qspi_seg *segs, int count)
+{
+	struct bus_retry_xfer xfer = { .op = BUS_RETRY_READV, .segs = segs, .count = count };
+
+	return bus_retry_run(&xfer);
+}
+
+static int bus_retry_writev(const struct qspi_seg *segs, int count)
+{
+	struct bus_retry_xfer xfer = { .op = BUS_RETRY_WRITEV, .segs = segs, .count = count };
+
+	return bus_retry_run(&xfer);
+}
+
+struct qspi_dev *bus_retry_dev(struct qspi_dev *bus)
+{
+	if (bus_dev) {
+		return &bus_retry_qdev;
+	}
+
+	bus_dev = bus;
+
+	/* Commands and asynchronous transfers go to the bus directly */
+	bus_retry_qdev = *bus;
+	bus_retry_qdev.read = bus_retry_read;
+	bus_retry_qdev.write = bus_retry_write;
+	bus_retry_qdev.hl_read = bus_retry_hl_read;
+	bus_retry_qdev.readv = bus_retry_readv;
+	bus_retry_qdev.writev = bus_retry_writev;
+
+	return &bus_retry_qdev;
+}
+
+void bus_err_stats_get(struct bus_err_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&bus_retry_lock);
+
+	*stats = bus_err_stats;
+
+	k_spin_unlock(&bus_retry_lock, key);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the bus transaction tracer for the Zephyr OS layer
+ * of the Wi-Fi driver. Transactions are recorded in a fixed-size ring that
+ * can be dumped and decoded offline with scripts/bus_trace_decode.py.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif /* CONFIG_SHELL */
+
+#include "bus_trace.h"
+
+#define BUS_TRACE_ENTRIES CONFIG_NRF700X_BUS_TRACE_ENTRIES
+#define BUS_TRACE_MASK (BUS_TRACE_ENTRIES - 1)
+
+BUILD_ASSERT((BUS_TRACE_ENTRIES & BUS_TRACE_MASK) == 0,
+	     "CONFIG_NRF700X_BUS_TRACE_ENTRIES must be a power of two");
+BUILD_ASSERT(sizeof(struct bus_trace_rec) == 16);
+
+static struct bus_trace_rec bus_trace_ring[BUS_TRACE_ENTRIES];
+
+/* Number of records ever added, writers claim a slot by incrementing it */
+static atomic_t bus_trace_head;
+
+void bus_trace_record(enum bus_trace_op op, uint32_t addr, uint32_t len, int ret,
+		      uint32_t start)
+{
+	uint32_t now = k_cycle_get_32();
+	struct bus_trace_rec *rec;
+
+	rec = &bus_trace_ring[(uint32_t)atomic_inc(&bus_trace_head) & BUS_TRACE_MASK];
+
+	rec->ts = start;
+	rec->dur = now - start;
+	rec->addr = addr;
+	rec->len = MIN(len, UINT16_MAX);
+	rec->op = op;
+	rec->ret = CLAMP(ret, INT8_MIN, INT8_MAX);
+}
+
+static void bus_trace_hdr_fill(struct bus_trace_hdr *hdr, uint32_t count)
+{
+	hdr->magic = BUS_TRACE_MAGIC;
+	hdr->version = BUS_TRACE_VERSION;
+	hdr->rec_size = sizeof(struct bus_trace_rec);
+	hdr->cycles_per_sec = sys_clock_hw_cycles_per_sec();
+	hdr->count = count;
+}
+
+size_t bus_trace_dump(void *buf, size_t size)
+{
+	uint32_t head = atomic_get(&bus_trace_head);
+	uint32_t count = MIN(head, BUS_TRACE_ENTRIES);
+	struct bus_trace_rec *recs;
+	uint32_t first;
+	uint32_t i;
+
+	if (!buf) {
+		return sizeof(struct bus_trace_hdr) + count * sizeof(struct bus_trace_rec);
+	}
+
+	if (size < sizeof(struct bus_trace_hdr)) {
+		return 0;
+	}
+
+	/* Keep the newest records if buf is too small for all of them */
+	count = MIN(count, (size - sizeof(struct bus_trace_hdr)) / sizeof(struct bus_trace_rec));
+	first = head - count;
+
+	bus_trace_hdr_fill(buf, count);
+
+	recs = (struct bus_trace_rec *)((uint8_t *)buf + sizeof(struct bus_trace_hdr));
+
+	for (i = 0; i < count; i++) {
+		recs[i] = bus_trace_ring[(first + i) & BUS_TRACE_MASK];
+	}
+
+	return sizeof(struct bus_trace_hdr) + count * sizeof(struct bus_trace_rec);
+}
+
+void bus_trace_clear(void)
+{
+	atomic_set(&bus_trace_head, 0);
+}
+
+#ifdef CONFIG_SHELL
+/* Prints the dump as one hex line for the header and one per record */
+static int cmd_bus_trace_dump(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t head = atomic_get(&bus_trace_head);
+	uint32_t count = MIN(head, BUS_TRACE_ENTRIES);
+	uint32_t first = head - count;
+	struct bus_trace_hdr hdr;
+	struct bus_trace_rec rec;
+	char hex[2 * sizeof(rec) + 1];
+	uint32_t i;
+
+	BUILD_ASSERT(sizeof(hdr) <= sizeof(rec));
+
+	bus_trace_hdr_fill(&hdr, count);
+
+	bin2hex((const uint8_t *)&hdr, sizeof(hdr), hex, sizeof(hex));
+	shell_print(sh, "%s", hex);
+
+	for (i = 0; i < count; i++) {
+		rec = bus_trace_ring[(first + i) & BUS_TRACE_MASK];
+
+		bin2hex((const uint8_t *)&rec, sizeof(rec), hex, sizeof(hex));
+		shell_print(sh, "%s", hex);
+	}
+
+	return 0;
+}
+
+static int cmd_bus_trace_clear(const struct shell *sh, size_t argc, char **argv)
+{
+	bus_trace_clear();
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	nrf70_bus_trace_cmds,
+	SHELL_CMD(dump, NULL, "Dump the bus trace as hex lines", cmd_bus_trace_dump),
+	SHELL_CMD(clear, NULL, "Clear the bus trace", cmd_bus_trace_clear),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(nrf70_bus_trace, &nrf70_bus_trace_cmds, "nRF70 bus transaction trace", NULL);
+#endif /* CONFIG_SHELL */
@@ -17,6 +17,12 @@
 
 #include "qspi_if.h"
 #include "spi_if.h"
+#ifdef CONFIG_NRF700X_BUS_OWNER_THREAD
+#include "bus_owner.h"
+#endif
+#ifdef CONFIG_NRF700X_BUS_RETRY
+#include "bus_retry.h"
+#endif
 
 static struct qspi_config config;
 
@@ -26,7 +32,22 @@ static struct qspi_dev qspi = {
 	.deinit = qspi_deinit,
 	.read = qspi_read,
 	.write = qspi_write,
-	.hl_read = qspi_hl_read
+	.hl_read = qspi_hl_read,
+	.readv = qspi_readv,
+	.writev = qspi_writev,
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+	.submit = qspi_submit,
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+	.bus_begin = qspi_bus_begin,
+	.bus_end = qspi_bus_end,
+	.set_freq = qspi_set_freq,
+	.get_freq = qspi_get_freq,
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+	.hl_burst_set = qspi_hl_burst_set,
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+#ifdef CONFIG_NRF700X_QSPI_XIP
+	.xip_read = qspi_xip_read,
+#endif /* CONFIG_NRF700X_QSPI_XIP */
 };
 #else
 static struct qspi_dev spim = {
@@ -34,7 +55,19 @@ static struct qspi_dev spim = {
 	.deinit = spim_deinit,
 	.read = spim_read,
 	.write = spim_write,
-	.hl_read = spim_hl_read
+	.hl_read = spim_hl_read,
+	.readv = spim_readv,
+	.writev = spim_writev,
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+	.submit = spim_submit,
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+	.bus_begin = spim_bus_begin,
+	.bus_end = spim_bus_end,
+	.set_freq = spim_set_freq,
+	.get_freq = spim_get_freq,
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+	.hl_burst_set = spim_hl_burst_set,
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
 };
 #endif
 
@@ -79,8 +112,30 @@ struct qspi_config *qspi_get_config(void)
 struct qspi_dev *qspi_dev(void)
 {
 #if CONFIG_NRF700X_ON_QSPI
-	return &qspi;
+	struct qspi_dev *dev = &qspi;
 #else
-	return &spim;
+	struct qspi_dev *dev = &spim;
+#endif
+
+#ifdef CONFIG_NRF700X_BUS_RETRY
+	/* Retries run in the bus owner thread if there is one */
+	dev = bus_retry_dev(dev);
 #endif
+
+#ifdef CONFIG_NRF700X_BUS_OWNER_THREAD
+	return bus_owner_dev(dev);
+#else
+	return dev;
+#endif
+}
+
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+int qspi_async_wait(struct qspi_async_xfer *xfer, k_timeout_t timeout)
+{
+	if (k_sem_take(&xfer->done, timeout)) {
+		return -EAGAIN;
+	}
+
+	return xfer->status;
 }
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
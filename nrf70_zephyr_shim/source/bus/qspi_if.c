@@ -23,15 +23,20 @@
 #include <nrfx_qspi.h>
 #include <hal/nrf_clock.h>
 #include <hal/nrf_gpio.h>
+#ifdef CONFIG_NRF700X_QSPI_XIP
+#include <hal/nrf_cache.h>
+#endif /* CONFIG_NRF700X_QSPI_XIP */
 
 #include "spi_nor.h"
 #include "qspi_if.h"
+#include "bus_trace.h"
 
 static struct qspi_config *qspi_config;
 #if NRF_QSPI_HAS_XIP_ENC || NRF_QSPI_HAS_DMA_ENC
 static unsigned int nonce_last_addr;
 static unsigned int nonce_cnt;
 #endif /*NRF_QSPI_HAS_XIP_ENC || NRF_QSPI_HAS_DMA_ENC*/
+static struct qspi_nonce_stats qspi_nonce_stats;
 
 /* Main config structure */
 static nrfx_qspi_config_t QSPIconfig;
@@ -89,6 +94,36 @@ BUILD_ASSERT(INST_0_SCK_FREQUENCY >= (NRF_QSPI_BASE_CLOCK_FREQ / 16),
 
 #endif /* defined(CONFIG_SOC_SERIES_NRF53X) */
 
+/* SCK frequency produced by an SCK configuration value */
+#define QSPI_SCK_CFG_FREQ(cfg) (NRF_QSPI_BASE_CLOCK_FREQ / ((cfg) + 1))
+
+/* SCK configuration for data transfers, starts from DTS and can be changed
+ * at runtime through qspi_set_freq(). The frequency is the one actually
+ * produced by the configuration, not the requested one.
+ */
+static uint32_t qspi_sck_freq = QSPI_SCK_CFG_FREQ(INST_0_SCK_CFG);
+static nrf_qspi_frequency_t qspi_sck_cfg = INST_0_SCK_CFG;
+
+/* Runtime version of the INST_0_SCK_CFG computation above */
+static nrf_qspi_frequency_t qspi_sck_cfg_get(uint32_t freq)
+{
+	uint32_t cfg;
+
+#if defined(CONFIG_SOC_SERIES_NRF53X)
+	if (freq >= (NRF_QSPI_BASE_CLOCK_FREQ / 4))
+		return NRF_QSPI_FREQ_DIV4;
+
+	cfg = DIV_ROUND_UP(NRF_QSPI_BASE_CLOCK_FREQ / 2, freq) - 1;
+#else
+	if (freq >= NRF_QSPI_BASE_CLOCK_FREQ)
+		return NRF_QSPI_FREQ_DIV1;
+
+	cfg = DIV_ROUND_UP(NRF_QSPI_BASE_CLOCK_FREQ, freq) - 1;
+#endif /* defined(CONFIG_SOC_SERIES_NRF53X) */
+
+	return (nrf_qspi_frequency_t)MIN(cfg, NRF_QSPI_FREQ_DIV16);
+}
+
 /* for accessing devicetree properties of the bus node */
 #define QSPI_NODE DT_BUS(DT_DRV_INST(0))
 #define QSPI_PROP_AT(prop, idx) DT_PROP_BY_IDX(QSPI_NODE, prop, idx)
@@ -103,6 +138,35 @@ static void qspi_device_uninit(const struct device *dev);
 #define QSPI_SCK_DELAY 0
 #define WORD_SIZE 4
 
+/* Largest slave latency (in words) of any RPU memory region */
+#define QSPI_HL_MAX_LATENCY 2
+
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+#define QSPI_HL_BURST_WORDS CONFIG_NRF700X_HL_READ_BURST_MAX_WORDS
+
+/* Bursts are only used once verified on the hardware */
+static bool qspi_hl_burst;
+#else
+#define QSPI_HL_BURST_WORDS 1
+#define qspi_hl_burst false
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+
+/* Bounce buffer for high-latency reads, protected by qspi_config->lock */
+static uint32_t qspi_hl_buf[QSPI_HL_BURST_WORDS + QSPI_HL_MAX_LATENCY];
+
+/* DMA buffers staging transfers whose caller buffer EasyDMA cannot use
+ * directly, protected by qspi_lock(). Two buffers are used in turn so that
+ * the next chunk is copied while the previous one is on the bus.
+ */
+BUILD_ASSERT((CONFIG_NRF700X_QSPI_BOUNCE_BUF_SIZE % WORD_SIZE) == 0,
+	     "QSPI bounce buffer size must be a multiple of 4");
+
+#define QSPI_BOUNCE_WORDS (CONFIG_NRF700X_QSPI_BOUNCE_BUF_SIZE / WORD_SIZE)
+#define QSPI_DMA_POOL_BUFS 2
+static uint32_t qspi_dma_pool[QSPI_DMA_POOL_BUFS][QSPI_BOUNCE_WORDS];
+
+static struct qspi_dma_stats qspi_dma_stats;
+
 LOG_MODULE_DECLARE(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
 
 /**
@@ -319,8 +383,61 @@ static inline struct qspi_nor_data *get_dev_data(const struct device *dev)
 	return dev->data;
 }
 
+/* Bus transaction bracket, see qspi_bus_begin() */
+static k_tid_t qspi_bus_owner;
+static int qspi_bus_depth;
+
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+/* Taken while an asynchronous transfer is in flight, given from the QSPI
+ * handler on completion.
+ */
+static K_SEM_DEFINE(qspi_async_idle, 1, 1);
+
+/* Inside a bus transaction the locks do not keep the owner's operations
+ * away from its own asynchronous transfer, they wait for it instead.
+ */
+static inline void qspi_async_drain(void)
+{
+	k_sem_take(&qspi_async_idle, K_FOREVER);
+	k_sem_give(&qspi_async_idle);
+}
+#else
+static inline void qspi_async_drain(void)
+{
+}
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+
+/* True while the calling thread holds the bus through qspi_bus_begin(),
+ * the locks below are then already taken and must not be taken again.
+ */
+static inline bool qspi_bus_owned(void)
+{
+#ifdef CONFIG_MULTITHREADING
+	return (qspi_bus_depth > 0) && (qspi_bus_owner == k_current_get());
+#else /* CONFIG_MULTITHREADING */
+	return (qspi_bus_depth > 0);
+#endif /* CONFIG_MULTITHREADING */
+}
+
+static inline void qspi_cfg_lock(void)
+{
+	if (!qspi_bus_owned())
+		k_sem_take(&qspi_config->lock, K_FOREVER);
+}
+
+static inline void qspi_cfg_unlock(void)
+{
+	if (!qspi_bus_owned())
+		k_sem_give(&qspi_config->lock);
+}
+
 static inline void qspi_lock(const struct device *dev)
 {
+	if (qspi_bus_owned()) {
+		qspi_async_drain();
+		return;
+	}
+
 #ifdef CONFIG_MULTITHREADING
 	struct qspi_nor_data *dev_data = get_dev_data(dev);
 
@@ -341,6 +458,9 @@ static inline void qspi_lock(const struct device *dev)
 
 static inline void qspi_unlock(const struct device *dev)
 {
+	if (qspi_bus_owned())
+		return;
+
 #if defined(CONFIG_SOC_SERIES_NRF53X)
 	/* Restore the default base clock divider to reduce power consumption.
 	 */
@@ -358,6 +478,9 @@ static inline void qspi_unlock(const struct device *dev)
 
 static inline void qspi_trans_lock(const struct device *dev)
 {
+	if (qspi_bus_owned())
+		return;
+
 #ifdef CONFIG_MULTITHREADING
 	struct qspi_nor_data *dev_data = get_dev_data(dev);
 
@@ -369,6 +492,9 @@ static inline void qspi_trans_lock(const struct device *dev)
 
 static inline void qspi_trans_unlock(const struct device *dev)
 {
+	if (qspi_bus_owned())
+		return;
+
 #ifdef CONFIG_MULTITHREADING
 	struct qspi_nor_data *dev_data = get_dev_data(dev);
 
@@ -430,23 +556,109 @@ static inline void _qspi_wait_for_completion(const struct device *dev, nrfx_err_
  * @param p_context Pointer to context. Use in interrupt handler.
  * @retval None
  */
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+/* Asynchronous transfer in flight, it owns the bus until completed */
+static struct qspi_async_xfer *qspi_async_cur;
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+
 static void qspi_handler(nrfx_qspi_evt_t event, void *p_context)
 {
 	struct qspi_nor_data *dev_data = p_context;
 
-	if (event == NRFX_QSPI_EVENT_DONE)
-		_qspi_complete(dev_data);
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+	struct qspi_async_xfer *xfer = qspi_async_cur;
+
+	if (xfer) {
+		qspi_async_cur = NULL;
+		/* Any other event ends the transfer with an error */
+		xfer->status = (event == NRFX_QSPI_EVENT_DONE) ? 0 : -EIO;
+		k_sem_give(&qspi_async_idle);
+		/* Locks are released and the callback run in thread context */
+		k_work_submit(&xfer->work);
+		return;
+	}
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+
+	if (event != NRFX_QSPI_EVENT_DONE)
+		return;
+
+	_qspi_complete(dev_data);
 }
 
 static bool qspi_initialized;
 
+#ifdef CONFIG_NRF700X_QSPI_IDLE_TIMEOUT_MS
+#define QSPI_IDLE_TIMEOUT_MS CONFIG_NRF700X_QSPI_IDLE_TIMEOUT_MS
+#else
+#define QSPI_IDLE_TIMEOUT_MS 0
+#endif
+
+static struct qspi_lp_stats qspi_lp_stats;
+
+static void qspi_device_power_down(void)
+{
+	while (nrfx_qspi_mem_busy_check() != NRFX_SUCCESS) {
+		if (IS_ENABLED(CONFIG_MULTITHREADING))
+			k_msleep(50);
+		else
+			k_busy_wait(50000);
+	}
+
+	nrfx_qspi_uninit();
+
+#ifndef CONFIG_PINCTRL
+	nrf_gpio_cfg_output(QSPI_PROP_AT(csn_pins, 0));
+	nrf_gpio_pin_set(QSPI_PROP_AT(csn_pins, 0));
+#endif
+
+	qspi_initialized = false;
+	qspi_lp_stats.uninit_cnt++;
+}
+
+#if QSPI_IDLE_TIMEOUT_MS > 0
+/* Delay before the idle power down is tried again */
+#define QSPI_IDLE_RETRY_MS 1
+
+static void qspi_idle_work_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(qspi_idle_work, qspi_idle_work_handler);
+
+/* Runs on the system work queue, which must not block: the power down is
+ * retried later while the bus is in use or the memory is busy.
+ */
+static void qspi_idle_work_handler(struct k_work *work)
+{
+	const struct device *dev = &qspi_perip;
+	struct qspi_nor_data *dev_data = get_dev_data(dev);
+
+	if (k_sem_take(&dev_data->sem, K_NO_WAIT) != 0) {
+		k_work_reschedule(&qspi_idle_work, K_MSEC(QSPI_IDLE_RETRY_MS));
+		return;
+	}
+
+#if defined(CONFIG_SOC_SERIES_NRF53X)
+	nrf_clock_hfclk192m_div_set(NRF_CLOCK, BASE_CLOCK_DIV);
+#endif
+
+	/* A new user may have shown up while the work was pending */
+	if (qspi_initialized && (k_sem_count_get(&dev_data->count) == 0)) {
+		if (nrfx_qspi_mem_busy_check() == NRFX_SUCCESS)
+			qspi_device_power_down();
+		else
+			k_work_reschedule(&qspi_idle_work, K_MSEC(QSPI_IDLE_RETRY_MS));
+	}
+
+	qspi_unlock(dev);
+}
+#endif /* QSPI_IDLE_TIMEOUT_MS > 0 */
+
 static int qspi_device_init(const struct device *dev)
 {
 	struct qspi_nor_data *dev_data = get_dev_data(dev);
 	nrfx_err_t res;
 	int ret = 0;
 
-	if (!IS_ENABLED(CONFIG_NRF700X_QSPI_LOW_POWER)) {
+	if (!IS_ENABLED(CONFIG_NRF700X_QSPI_LOW_POWER) || qspi_bus_owned()) {
 		return 0;
 	}
 
@@ -465,6 +677,9 @@ static int qspi_device_init(const struct device *dev)
 		ret = qspi_get_zephyr_ret_code(res);
 		NRF_QSPI->IFTIMING |= qspi_config->RDC4IO;
 		qspi_initialized = (ret == 0);
+		qspi_lp_stats.init_cnt++;
+	} else {
+		qspi_lp_stats.reuse_cnt++;
 	}
 
 	qspi_unlock(dev);
@@ -476,7 +691,7 @@ static void qspi_device_uninit(const struct device *dev)
 {
 	bool last = true;
 
-	if (!IS_ENABLED(CONFIG_NRF700X_QSPI_LOW_POWER)) {
+	if (!IS_ENABLED(CONFIG_NRF700X_QSPI_LOW_POWER) || qspi_bus_owned()) {
 		return;
 	}
 
@@ -490,24 +705,33 @@ static void qspi_device_uninit(const struct device *dev)
 	last = (k_sem_count_get(&dev_data->count) == 0);
 #endif
 
-	if (last) {
-		while (nrfx_qspi_mem_busy_check() != NRFX_SUCCESS) {
-			if (IS_ENABLED(CONFIG_MULTITHREADING))
-				k_msleep(50);
-			else
-				k_busy_wait(50000);
-		}
+	if (last && qspi_initialized) {
+#if QSPI_IDLE_TIMEOUT_MS > 0
+		/* Restart the idle period, power down once it expires */
+		k_work_reschedule(&qspi_idle_work, K_MSEC(QSPI_IDLE_TIMEOUT_MS));
+#else
+		qspi_device_power_down();
+#endif
+	}
 
-		nrfx_qspi_uninit();
+	qspi_unlock(dev);
+}
 
-#ifndef CONFIG_PINCTRL
-		nrf_gpio_cfg_output(QSPI_PROP_AT(csn_pins, 0));
-		nrf_gpio_pin_set(QSPI_PROP_AT(csn_pins, 0));
-#endif
+void qspi_lp_stats_get(struct qspi_lp_stats *stats)
+{
+	const struct device *dev = &qspi_perip;
 
-		qspi_initialized = false;
-	}
+	qspi_lock(dev);
+	*stats = qspi_lp_stats;
+	qspi_unlock(dev);
+}
+
+void qspi_dma_stats_get(struct qspi_dma_stats *stats)
+{
+	const struct device *dev = &qspi_perip;
 
+	qspi_lock(dev);
+	*stats = qspi_dma_stats;
 	qspi_unlock(dev);
 }
 
@@ -636,7 +860,7 @@ static inline void qspi_fill_init_struct(nrfx_qspi_config_t *initstruct)
 	initstruct->prot_if.dpmconfig = false;
 
 	/* Configure physical interface */
-	initstruct->phy_if.sck_freq = INST_0_SCK_CFG;
+	initstruct->phy_if.sck_freq = qspi_sck_cfg;
 	/* Using MHZ fails checkpatch constant check */
 	if (INST_0_SCK_FREQUENCY >= 16000000) {
 		qspi_config->qspi_slave_latency = 1;
@@ -738,72 +962,61 @@ static int qspi_nrfx_configure(const struct device *dev)
 	return ret;
 }
 
-static inline nrfx_err_t read_non_aligned(const struct device *dev, int addr, void *dest,
-					  size_t size)
+/* EasyDMA can only access RAM and transfers whole words */
+static inline bool qspi_dma_direct(const void *buf, int addr, size_t size)
 {
-	uint8_t __aligned(WORD_SIZE) buf[WORD_SIZE * 2];
-	uint8_t *dptr = dest;
-
-	int flash_prefix = (WORD_SIZE - (addr % WORD_SIZE)) % WORD_SIZE;
-
-	if (flash_prefix > size)
-		flash_prefix = size;
-
-	int dest_prefix = (WORD_SIZE - (int)dptr % WORD_SIZE) % WORD_SIZE;
-
-	if (dest_prefix > size)
-		dest_prefix = size;
-
-	int flash_suffix = (size - flash_prefix) % WORD_SIZE;
-	int flash_middle = size - flash_prefix - flash_suffix;
-	int dest_middle = size - dest_prefix - (size - dest_prefix) % WORD_SIZE;
+	return nrfx_is_in_ram(buf) && nrfx_is_word_aligned(buf) &&
+	       !(addr % WORD_SIZE) && !(size % WORD_SIZE);
+}
 
-	if (flash_middle > dest_middle) {
-		flash_middle = dest_middle;
-		flash_suffix = size - flash_prefix - flash_middle;
-	}
+/**
+ * struct qspi_span_ctx - DMA reads of qspi_span_read().
+ * @dev: QSPI device.
+ * @res: Result of the last read.
+ */
+struct qspi_span_ctx {
+	const struct device *dev;
+	nrfx_err_t res;
+};
 
-	nrfx_err_t res = NRFX_SUCCESS;
+static int qspi_span_dma_read(void *ctx, unsigned int addr, void *buf, size_t len)
+{
+	struct qspi_span_ctx *span = ctx;
 
-	/* read from aligned flash to aligned memory */
-	if (flash_middle != 0) {
-		res = _nrfx_qspi_read(dptr + dest_prefix, flash_middle, addr + flash_prefix);
+	span->res = _nrfx_qspi_read(buf, len, addr);
 
-		_qspi_wait_for_completion(dev, res);
+	_qspi_wait_for_completion(span->dev, span->res);
 
-		if (res != NRFX_SUCCESS)
-			return res;
+	return (span->res == NRFX_SUCCESS) ? 0 : -EIO;
+}
 
-		/* perform shift in RAM */
-		if (flash_prefix != dest_prefix)
-			memmove(dptr + flash_prefix, dptr + dest_prefix, flash_middle);
-	}
+static inline nrfx_err_t read_non_aligned(const struct device *dev, int addr, void *dest,
+					  size_t size)
+{
+	struct qspi_span_ctx span = {
+		.dev = dev,
+		.res = NRFX_SUCCESS,
+	};
+	uint8_t *dptr = dest;
+	nrfx_err_t res;
 
-	/* read prefix */
-	if (flash_prefix != 0) {
-		res = _nrfx_qspi_read(buf, WORD_SIZE, addr - (WORD_SIZE - flash_prefix));
+	/* DMA straight into the caller's buffer */
+	if (qspi_dma_direct(dptr, addr, size)) {
+		res = _nrfx_qspi_read(dptr, size, addr);
 
 		_qspi_wait_for_completion(dev, res);
 
-		if (res != NRFX_SUCCESS)
-			return res;
+		if (res == NRFX_SUCCESS)
+			qspi_dma_stats.zero_copy_bytes += size;
 
-		memcpy(dptr, buf + WORD_SIZE - flash_prefix, flash_prefix);
+		return res;
 	}
 
-	/* read suffix */
-	if (flash_suffix != 0) {
-		res = _nrfx_qspi_read(buf, WORD_SIZE * 2, addr + flash_prefix + flash_middle);
-
-		_qspi_wait_for_completion(dev, res);
-
-		if (res != NRFX_SUCCESS)
-			return res;
-
-		memcpy(dptr + flash_prefix + flash_middle, buf, flash_suffix);
-	}
+	if (!qspi_span_read(addr, dptr, size, qspi_dma_pool[0], sizeof(qspi_dma_pool[0]),
+			    qspi_span_dma_read, &span))
+		qspi_dma_stats.staged_bytes += size;
 
-	return res;
+	return span.res;
 }
 
 static int qspi_nor_read(const struct device *dev, int addr, void *dest, size_t size)
@@ -855,17 +1068,86 @@ static inline nrfx_err_t write_sub_word(const struct device *dev, int addr, cons
 	return res;
 }
 
-static int qspi_nor_write(const struct device *dev, int addr, const void *src, size_t size)
+static inline bool write_is_valid(int addr, const void *src, size_t size)
 {
 	if (!src)
-		return -EINVAL;
+		return false;
 
 	/* write size must be non-zero, less than 4, or a multiple of 4 */
 	if ((size == 0) || ((size > 4) && ((size % 4U) != 0)))
-		return -EINVAL;
+		return false;
 
 	/* address must be 4-byte aligned */
 	if ((addr % 4U) != 0)
+		return false;
+
+	return true;
+}
+
+/* Source outside RAM (e.g. firmware patches in flash) or unaligned, stage
+ * it through the DMA pool. The next chunk is copied into the other buffer
+ * while the current one is being written.
+ */
+static nrfx_err_t write_staged(const struct device *dev, int addr, const void *src,
+			       size_t size)
+{
+	const uint8_t *sptr = src;
+	size_t len = MIN(size, sizeof(qspi_dma_pool[0]));
+	size_t next;
+	nrfx_err_t res;
+	int cur = 0;
+
+	memcpy(qspi_dma_pool[cur], sptr, len);
+
+	while (size) {
+		res = _nrfx_qspi_write(qspi_dma_pool[cur], len, addr);
+
+		if (res != NRFX_SUCCESS)
+			return res;
+
+		addr += len;
+		sptr += len;
+		size -= len;
+
+		next = MIN(size, sizeof(qspi_dma_pool[0]));
+
+		if (next)
+			memcpy(qspi_dma_pool[cur ^ 1], sptr, next);
+
+		_qspi_wait_for_completion(dev, res);
+
+		qspi_dma_stats.staged_bytes += len;
+
+		cur ^= 1;
+		len = next;
+	}
+
+	return NRFX_SUCCESS;
+}
+
+/* addr aligned, size validated by write_is_valid() */
+static inline nrfx_err_t write_aligned(const struct device *dev, int addr, const void *src,
+				       size_t size)
+{
+	nrfx_err_t res;
+
+	if (size < 4U)
+		res = write_sub_word(dev, addr, src, size);
+	else if (qspi_dma_direct(src, addr, size)) {
+		res = _nrfx_qspi_write(src, size, addr);
+		_qspi_wait_for_completion(dev, res);
+
+		if (res == NRFX_SUCCESS)
+			qspi_dma_stats.zero_copy_bytes += size;
+	} else
+		res = write_staged(dev, addr, src, size);
+
+	return res;
+}
+
+static int qspi_nor_write(const struct device *dev, int addr, const void *src, size_t size)
+{
+	if (!write_is_valid(addr, src, size))
 		return -EINVAL;
 
 	nrfx_err_t res = NRFX_SUCCESS;
@@ -879,12 +1161,7 @@ static int qspi_nor_write(const struct device *dev, int addr, const void *src, s
 
 	qspi_lock(dev);
 
-	if (size < 4U)
-		res = write_sub_word(dev, addr, src, size);
-	else {
-		res = _nrfx_qspi_write(src, size, addr);
-		_qspi_wait_for_completion(dev, res);
-	}
+	res = write_aligned(dev, addr, src, size);
 
 	qspi_unlock(dev);
 
@@ -973,6 +1250,7 @@ int qspi_RDSR2(const struct device *dev, uint8_t *rdsr2)
 		.op_code = 0x2f,
 		.rx_buf = &sr_buf,
 	};
+	uint32_t start = bus_trace_start();
 
 	ret = qspi_device_init(dev);
 
@@ -980,6 +1258,8 @@ int qspi_RDSR2(const struct device *dev, uint8_t *rdsr2)
 
 	qspi_device_uninit(dev);
 
+	bus_trace_record(BUS_TRACE_RDSR2, 0, sizeof(sr), ret, start);
+
 	LOG_DBG("RDSR2 = 0x%x", sr);
 
 	if (ret == 0)
@@ -991,17 +1271,27 @@ int qspi_RDSR2(const struct device *dev, uint8_t *rdsr2)
 /* Wait until RDSR2 confirms RPU_WAKE write is successful */
 int qspi_validate_rpu_wake_writecmd(const struct device *dev)
 {
-	int ret = 0;
+	int ret;
 	uint8_t rdsr2 = 0;
+	uint32_t delay_us = RPU_WAKE_POLL_MIN_US;
+	uint32_t waited_us = 0;
 
-	for (int ii = 0; ii < 1; ii++) {
+	while (1) {
 		ret = qspi_RDSR2(dev, &rdsr2);
-		if (!ret && (rdsr2 & RPU_WAKEUP_NOW)) {
-			return 0;
+
+		if ((!ret && (rdsr2 & RPU_WAKEUP_NOW)) || (waited_us >= RPU_WAKE_TIMEOUT_US)) {
+			break;
 		}
+
+		waited_us += rpu_wake_poll_delay(&delay_us);
 	}
 
-	return -1;
+	if (ret || !(rdsr2 & RPU_WAKEUP_NOW)) {
+		LOG_ERR("RPU wakeup write ACK failed even after %d us", waited_us);
+		return -1;
+	}
+
+	return 0;
 }
 
 
@@ -1018,6 +1308,7 @@ int qspi_RDSR1(const struct device *dev, uint8_t *rdsr1)
 		.op_code = 0x1f,
 		.rx_buf = &sr_buf,
 	};
+	uint32_t start = bus_trace_start();
 
 	ret = qspi_device_init(dev);
 
@@ -1025,6 +1316,8 @@ int qspi_RDSR1(const struct device *dev, uint8_t *rdsr1)
 
 	qspi_device_uninit(dev);
 
+	bus_trace_record(BUS_TRACE_RDSR1, 0, sizeof(sr), ret, start);
+
 	LOG_DBG("RDSR1 = 0x%x", sr);
 
 	if (ret == 0)
@@ -1038,26 +1331,28 @@ int qspi_wait_while_rpu_awake(const struct device *dev)
 {
 	int ret;
 	uint8_t val = 0;
+	uint32_t delay_us = RPU_WAKE_POLL_MIN_US;
+	uint32_t waited_us = 0;
 
-	for (int ii = 0; ii < 10; ii++) {
+	while (1) {
 		ret = qspi_RDSR1(dev, &val);
 
 		LOG_DBG("RDSR1 = 0x%x", val);
 
-		if (!ret && (val & RPU_AWAKE_BIT)) {
+		if ((!ret && (val & RPU_AWAKE_BIT)) || (waited_us >= RPU_WAKE_TIMEOUT_US)) {
 			break;
 		}
 
-		k_msleep(1);
+		waited_us += rpu_wake_poll_delay(&delay_us);
 	}
 
 	if (ret || !(val & RPU_AWAKE_BIT)) {
-		LOG_ERR("RPU is not awake even after 10ms");
+		LOG_ERR("RPU is not awake even after %d us", waited_us);
 		return -1;
 	}
 
-	/* Restore QSPI clock frequency from DTS */
-	QSPIconfig.phy_if.sck_freq = INST_0_SCK_CFG;
+	/* Restore QSPI clock frequency for data transfers */
+	QSPIconfig.phy_if.sck_freq = qspi_sck_cfg;
 
 	return val;
 }
@@ -1072,6 +1367,7 @@ int qspi_WRSR2(const struct device *dev, uint8_t data)
 		.op_code = 0x3f,
 		.tx_buf = &tx_buf,
 	};
+	uint32_t start = bus_trace_start();
 	int ret = qspi_device_init(dev);
 
 	if (ret == 0)
@@ -1079,6 +1375,8 @@ int qspi_WRSR2(const struct device *dev, uint8_t data)
 
 	qspi_device_uninit(dev);
 
+	bus_trace_record(BUS_TRACE_WRSR2, 0, sizeof(data), ret, start);
+
 	if (ret < 0)
 		LOG_ERR("cmd_wakeup RPU failed %d", ret);
 
@@ -1097,6 +1395,39 @@ int qspi_cmd_wakeup_rpu(const struct device *dev, uint8_t data)
 	return ret;
 }
 
+int qspi_set_freq(uint32_t freq)
+{
+	const struct device *dev = &qspi_perip;
+
+	if (freq < (NRF_QSPI_BASE_CLOCK_FREQ / 16))
+		return -EINVAL;
+
+	qspi_cfg_lock();
+	qspi_lock(dev);
+
+	qspi_sck_cfg = qspi_sck_cfg_get(freq);
+	qspi_sck_freq = QSPI_SCK_CFG_FREQ(qspi_sck_cfg);
+	QSPIconfig.phy_if.sck_freq = qspi_sck_cfg;
+	/* As at init, high-latency reads need a latency word from 16 MHz on */
+	qspi_config->qspi_slave_latency = (qspi_sck_freq >= 16000000) ? 1 : 0;
+
+	/* Otherwise applied at the next nrfx_qspi_init() */
+	if (!IS_ENABLED(CONFIG_NRF700X_QSPI_LOW_POWER) || qspi_initialized)
+		nrf_qspi_ifconfig1_set(NRF_QSPI, &QSPIconfig.phy_if);
+
+	qspi_unlock(dev);
+	qspi_cfg_unlock();
+
+	LOG_DBG("QSPI freq = %d Hz for %d Hz (sck cfg %d)", qspi_sck_freq, freq, qspi_sck_cfg);
+
+	return 0;
+}
+
+uint32_t qspi_get_freq(void)
+{
+	return qspi_sck_freq;
+}
+
 struct device qspi_perip = {
 	.data = &qspi_nor_memory_data,
 };
@@ -1124,7 +1455,57 @@ int qspi_init(struct qspi_config *config)
 	return rc;
 }
 
-void qspi_update_nonce(unsigned int addr, int len, int hlread)
+int qspi_bus_begin(void)
+{
+	const struct device *dev = &qspi_perip;
+	int ret;
+
+	if (qspi_bus_owned()) {
+		qspi_bus_depth++;
+		return 0;
+	}
+
+	k_sem_take(&qspi_config->lock, K_FOREVER);
+
+	ret = qspi_device_init(dev);
+
+	if (ret != 0) {
+		qspi_device_uninit(dev);
+		k_sem_give(&qspi_config->lock);
+		return ret;
+	}
+
+	qspi_trans_lock(dev);
+	qspi_lock(dev);
+
+	qspi_bus_owner = k_current_get();
+	qspi_bus_depth = 1;
+
+	return 0;
+}
+
+void qspi_bus_end(void)
+{
+	const struct device *dev = &qspi_perip;
+
+	if (!qspi_bus_owned()) {
+		LOG_ERR("%s: Bus not held by caller", __func__);
+		return;
+	}
+
+	if (--qspi_bus_depth > 0)
+		return;
+
+	qspi_bus_owner = NULL;
+
+	qspi_unlock(dev);
+	qspi_trans_unlock(dev);
+	qspi_device_uninit(dev);
+
+	k_sem_give(&qspi_config->lock);
+}
+
+void qspi_update_nonce(unsigned int addr, int len, int hlread, bool write)
 {
 #if NRF_QSPI_HAS_XIP_ENC || NRF_QSPI_HAS_DMA_ENC
 
@@ -1133,108 +1514,427 @@ void qspi_update_nonce(unsigned int addr, int len, int hlread)
 	if (!qspi_config->encryption)
 		return;
 
-	if (nonce_last_addr == 0 || hlread)
-		p_reg->DMA_ENC.NONCE2 = ++nonce_cnt;
-	else if ((nonce_last_addr + 4) != addr)
+	qspi_nonce_stats.transfers[write]++;
+
+	/* A transfer continuing the previous one keeps the nonce */
+	if (nonce_last_addr == 0 || hlread || (nonce_last_addr + 4) != addr) {
 		p_reg->DMA_ENC.NONCE2 = ++nonce_cnt;
+		qspi_nonce_stats.updates[write]++;
+	}
 
 	nonce_last_addr = addr + len - 4;
 
 #endif /*NRF_QSPI_HAS_XIP_ENC || NRF_QSPI_HAS_DMA_ENC*/
 }
 
-void qspi_addr_check(unsigned int addr, const void *data, unsigned int len)
+void qspi_nonce_stats_get(struct qspi_nonce_stats *stats)
 {
-	if ((addr % 4 != 0) || (((unsigned int)data) % 4 != 0) || (len % 4 != 0)) {
+	qspi_cfg_lock();
+	*stats = qspi_nonce_stats;
+	qspi_cfg_unlock();
+}
+
+/* Unaligned host buffers are staged through the DMA buffers */
+int qspi_addr_check(unsigned int addr, const void *data, unsigned int len)
+{
+	if ((addr % 4 != 0) || (len % 4 != 0)) {
 		LOG_ERR("%s : Unaligned address %x %x %d %x %x", __func__, addr,
 		       (unsigned int)data, (addr % 4 != 0), (((unsigned int)data) % 4 != 0),
 		       (len % 4 != 0));
+		return -EINVAL;
 	}
+
+	return 0;
 }
 
 int qspi_write(unsigned int addr, const void *data, int len)
 {
+	uint32_t start = bus_trace_start();
 	int status;
 
-	qspi_addr_check(addr, data, len);
+	status = qspi_addr_check(addr, data, len);
+
+	if (status)
+		return status;
 
 	addr |= qspi_config->addrmask;
 
-	k_sem_take(&qspi_config->lock, K_FOREVER);
+	qspi_cfg_lock();
 
-	qspi_update_nonce(addr, len, 0);
+	qspi_update_nonce(addr, len, 0, true);
 
 	status = qspi_nor_write(&qspi_perip, addr, data, len);
 
-	k_sem_give(&qspi_config->lock);
+	qspi_cfg_unlock();
+
+	bus_trace_record(BUS_TRACE_WRITE, addr, len, status, start);
 
 	return status;
 }
 
 int qspi_read(unsigned int addr, void *data, int len)
 {
+	uint32_t start = bus_trace_start();
 	int status;
 
-	qspi_addr_check(addr, data, len);
+	status = qspi_addr_check(addr, data, len);
+
+	if (status)
+		return status;
 
 	addr |= qspi_config->addrmask;
 
-	k_sem_take(&qspi_config->lock, K_FOREVER);
+	qspi_cfg_lock();
 
-	qspi_update_nonce(addr, len, 0);
+	qspi_update_nonce(addr, len, 0, false);
 
 	status = qspi_nor_read(&qspi_perip, addr, data, len);
 
-	k_sem_give(&qspi_config->lock);
+	qspi_cfg_unlock();
+
+	bus_trace_record(BUS_TRACE_READ, addr, len, status, start);
 
 	return status;
 }
 
-int qspi_hl_readw(unsigned int addr, void *data)
+#ifdef CONFIG_NRF700X_QSPI_XIP
+/* XIP window of the QSPI peripheral, xip_offset is 0 so it starts at RPU
+ * address 0.
+ */
+#define QSPI_XIP_BASE DT_REG_ADDR_BY_NAME(QSPI_NODE, qspi_mm)
+
+int qspi_xip_read(unsigned int addr, void *data, int len)
 {
-	int status;
-	uint8_t *rxb = NULL;
-	uint32_t len = 4;
+	const struct device *dev = &qspi_perip;
+	int rc;
+
+	if ((addr % WORD_SIZE) || (len % WORD_SIZE))
+		return -EINVAL;
+
+	/* Mapped reads would be decrypted with the XIP key and nonce, which
+	 * the RPU does not use.
+	 */
+	if (qspi_config->encryption)
+		return qspi_read(addr, data, len);
+
+	addr |= qspi_config->addrmask;
+
+	qspi_cfg_lock();
+
+	rc = qspi_device_init(dev);
+
+	if (rc != 0)
+		goto out;
+
+	/* Mapped reads stall while a task is running, keep the peripheral
+	 * to ourselves for the duration of the copy.
+	 */
+	qspi_lock(dev);
+
+#ifdef NRF_CACHE
+	/* RPU memory changes behind the cache */
+	nrf_cache_invalidate(NRF_CACHE);
+#endif /* NRF_CACHE */
+
+	qspi_xip_copy((const volatile void *)QSPI_XIP_BASE, addr, data, len);
+
+	qspi_unlock(dev);
+
+out:
+	qspi_device_uninit(dev);
 
-	len = len + (4 * qspi_config->qspi_slave_latency);
+	qspi_cfg_unlock();
+
+	return rc;
+}
+#endif /* CONFIG_NRF700X_QSPI_XIP */
 
-	rxb = k_malloc(len);
+/* Run all segments under a single lock, peripheral init and clock divider
+ * window instead of one per segment.
+ */
+int qspi_readv(const struct qspi_seg *segs, int count)
+{
+	const struct device *dev = &qspi_perip;
+	nrfx_err_t res = NRFX_SUCCESS;
+	uint32_t start = bus_trace_start();
+	unsigned int addr;
+	uint8_t order_buf[QSPI_SEG_SORT_MAX];
+	const struct qspi_seg *seg;
+	const uint8_t *order;
+	int len = 0;
+	int run, n;
+	int rc;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (!segs[i].data || (segs[i].len < 0) ||
+		    qspi_addr_check(segs[i].addr, segs[i].data, segs[i].len))
+			return -EINVAL;
 
-	if (rxb == NULL) {
-		LOG_ERR("%s: ERROR ENOMEM line %d", __func__, __LINE__);
-		return -ENOMEM;
+		len += segs[i].len;
 	}
 
-	memset(rxb, 0, len);
+	qspi_cfg_lock();
 
-	k_sem_take(&qspi_config->lock, K_FOREVER);
+	rc = qspi_device_init(dev);
 
-	qspi_update_nonce(addr, 4, 1);
+	if (rc != 0)
+		goto out;
 
-	status = qspi_nor_read(&qspi_perip, addr, rxb, len);
+	qspi_lock(dev);
 
-	k_sem_give(&qspi_config->lock);
+	/* In encrypted mode every segment that does not continue the previous
+	 * one costs a nonce update.
+	 */
+	order = qspi_config->encryption ? qspi_seg_order(segs, count, false, order_buf) : NULL;
+
+	for (i = 0; (i < count) && (res == NRFX_SUCCESS); i += n) {
+		seg = qspi_seg_at(segs, order, i);
+		run = qspi_seg_run(segs, order, i, count, &n);
 
-	*(uint32_t *)data = *(uint32_t *)(rxb + (len - 4));
+		addr = seg->addr | qspi_config->addrmask;
+
+		qspi_update_nonce(addr, run, 0, false);
+
+		res = read_non_aligned(dev, addr, seg->data, run);
+	}
+
+	qspi_unlock(dev);
+
+	rc = qspi_get_zephyr_ret_code(res);
+out:
+	qspi_device_uninit(dev);
 
-	k_free(rxb);
+	qspi_cfg_unlock();
+
+	bus_trace_record(BUS_TRACE_READV, count ? segs[0].addr : 0, len, rc, start);
+
+	return rc;
+}
+
+int qspi_writev(const struct qspi_seg *segs, int count)
+{
+	const struct device *dev = &qspi_perip;
+	nrfx_err_t res = NRFX_SUCCESS;
+	uint32_t start = bus_trace_start();
+	unsigned int addr;
+	uint8_t order_buf[QSPI_SEG_SORT_MAX];
+	const struct qspi_seg *seg;
+	const uint8_t *order;
+	int len = 0;
+	int run, n;
+	int rc;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (!write_is_valid(segs[i].addr, segs[i].data, segs[i].len))
+			return -EINVAL;
+
+		len += segs[i].len;
+	}
+
+	qspi_cfg_lock();
+
+	rc = qspi_device_init(dev);
+
+	if (rc != 0)
+		goto out;
+
+	qspi_trans_lock(dev);
+
+	qspi_lock(dev);
+
+	order = qspi_config->encryption ? qspi_seg_order(segs, count, true, order_buf) : NULL;
+
+	for (i = 0; (i < count) && (res == NRFX_SUCCESS); i += n) {
+		seg = qspi_seg_at(segs, order, i);
+		run = qspi_seg_run(segs, order, i, count, &n);
+
+		addr = seg->addr | qspi_config->addrmask;
+
+		qspi_update_nonce(addr, run, 0, true);
+
+		res = write_aligned(dev, addr, seg->data, run);
+	}
+
+	qspi_unlock(dev);
+
+	qspi_trans_unlock(dev);
+
+	rc = qspi_get_zephyr_ret_code(res);
+out:
+	qspi_device_uninit(dev);
+
+	qspi_cfg_unlock();
+
+	bus_trace_record(BUS_TRACE_WRITEV, count ? segs[0].addr : 0, len, rc, start);
+
+	return rc;
+}
+
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+static void qspi_async_release(struct qspi_async_xfer *xfer)
+{
+	const struct device *dev = &qspi_perip;
+
+	/* Submitted inside a bus transaction, the owner keeps the locks */
+	if (xfer->in_bus_txn)
+		return;
+
+	qspi_unlock(dev);
+
+	if (xfer->write)
+		qspi_trans_unlock(dev);
+
+	qspi_device_uninit(dev);
+
+	qspi_cfg_unlock();
+}
+
+static void qspi_async_work_handler(struct k_work *work)
+{
+	struct qspi_async_xfer *xfer = CONTAINER_OF(work, struct qspi_async_xfer, work);
+
+	qspi_async_release(xfer);
+
+	if (xfer->cb)
+		xfer->cb(xfer);
+
+	/* Last access to xfer, the waiter may release it */
+	k_sem_give(&xfer->done);
+}
+
+int qspi_submit(struct qspi_async_xfer *xfer)
+{
+	const struct device *dev = &qspi_perip;
+	unsigned int addr;
+	nrfx_err_t res;
+	int rc;
+
+	/* EasyDMA moves the data straight from/to the caller's buffer */
+	if (!qspi_config->easydma || !xfer->data || (xfer->len <= 0) ||
+	    !qspi_dma_direct(xfer->data, xfer->addr, xfer->len))
+		return -EINVAL;
+
+	k_work_init(&xfer->work, qspi_async_work_handler);
+	k_sem_init(&xfer->done, 0, 1);
+	xfer->in_bus_txn = qspi_bus_owned();
+
+	qspi_cfg_lock();
+
+	rc = qspi_device_init(dev);
+
+	if (rc != 0) {
+		qspi_device_uninit(dev);
+		qspi_cfg_unlock();
+		return rc;
+	}
+
+	if (xfer->write)
+		qspi_trans_lock(dev);
+
+	qspi_lock(dev);
+
+	addr = xfer->addr | qspi_config->addrmask;
+
+	qspi_update_nonce(addr, xfer->len, 0, xfer->write);
+
+	k_sem_take(&qspi_async_idle, K_FOREVER);
+
+	qspi_async_cur = xfer;
+
+	if (xfer->write)
+		res = _nrfx_qspi_write(xfer->data, xfer->len, addr);
+	else
+		res = _nrfx_qspi_read(xfer->data, xfer->len, addr);
+
+	if (res != NRFX_SUCCESS) {
+		qspi_async_cur = NULL;
+		k_sem_give(&qspi_async_idle);
+		qspi_async_release(xfer);
+		return qspi_get_zephyr_ret_code(res);
+	}
+
+	return 0;
+}
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+
+/* Read nwords from a high-latency region, the slave latency dummy words
+ * precede the data and are discarded.
+ */
+static int qspi_hl_read_words(unsigned int addr, void *data, int nwords, unsigned int latency)
+{
+	int status;
+	uint32_t len = WORD_SIZE * (nwords + latency);
+
+	if (latency > QSPI_HL_MAX_LATENCY) {
+		LOG_ERR("%s: Unsupported slave latency %d", __func__, latency);
+		return -EINVAL;
+	}
+
+	/* A burst relies on the RPU incrementing the address after the
+	 * latency words, a single word is read in fixed address mode.
+	 */
+	if (nwords > 1) {
+		addr |= qspi_config->addrmask;
+	}
+
+	qspi_cfg_lock();
+
+	qspi_update_nonce(addr, WORD_SIZE * nwords, 1, false);
+
+	status = qspi_nor_read(&qspi_perip, addr, qspi_hl_buf, len);
+
+	if (status == 0) {
+		memcpy(data, &qspi_hl_buf[latency], WORD_SIZE * nwords);
+	}
+
+	qspi_cfg_unlock();
 
 	return status;
 }
 
-int qspi_hl_read(unsigned int addr, void *data, int len)
+int qspi_hl_readw(unsigned int addr, void *data, unsigned int latency)
 {
+	return qspi_hl_read_words(addr, data, 1, latency);
+}
+
+int qspi_hl_read(unsigned int addr, void *data, int len, unsigned int latency)
+{
+	uint32_t start = bus_trace_start();
 	int count = 0;
+	int nwords;
+	int status;
+
+	/* Reads are done in whole words */
+	status = qspi_addr_check(addr, data, len);
 
-	qspi_addr_check(addr, data, len);
+	while (!status && (count < (len / 4))) {
+		nwords = qspi_hl_burst ? MIN((len / 4) - count, QSPI_HL_BURST_WORDS) : 1;
+
+		status = qspi_hl_read_words(addr + (4 * count),
+					    ((char *)data + (4 * count)),
+					    nwords, latency);
+		if (status) {
+			break;
+		}
 
-	while (count < (len / 4)) {
-		qspi_hl_readw(addr + (4 * count), ((char *)data + (4 * count)));
-		count++;
+		count += nwords;
 	}
 
-	return 0;
+	bus_trace_record(BUS_TRACE_HL_READ, addr, len, status, start);
+
+	return status;
+}
+
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+void qspi_hl_burst_set(bool enable)
+{
+	qspi_cfg_lock();
+	qspi_hl_burst = enable;
+	qspi_cfg_unlock();
 }
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
 
 int qspi_cmd_sleep_rpu(const struct device *dev)
 {
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the segment ordering and merging of vectored QSPI
+ * transfers for the Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#include <zephyr/kernel.h>
+
+#include "qspi_if.h"
+
+#define QSPI_SEG_WORD_SIZE 4
+
+const uint8_t *qspi_seg_order(const struct qspi_seg *segs, int count, bool write,
+			      uint8_t *order)
+{
+	const struct qspi_seg *a, *b;
+	uint8_t v;
+	int i, j;
+
+	if ((count < 2) || (count > QSPI_SEG_SORT_MAX))
+		return NULL;
+
+	for (i = 0; i < count; i++) {
+		v = i;
+
+		for (j = i; (j > 0) && (segs[order[j - 1]].addr > segs[v].addr); j--)
+			order[j] = order[j - 1];
+
+		order[j] = v;
+	}
+
+	for (i = 1; write && (i < count); i++) {
+		a = &segs[order[i - 1]];
+		b = &segs[order[i]];
+
+		if (a->addr + a->len > b->addr)
+			return NULL;
+	}
+
+	return order;
+}
+
+int qspi_seg_run(const struct qspi_seg *segs, const uint8_t *order, int i, int count, int *n)
+{
+	const struct qspi_seg *seg = qspi_seg_at(segs, order, i);
+	const struct qspi_seg *next;
+	int len = seg->len;
+
+	for (*n = 1; (i + *n) < count; (*n)++) {
+		next = qspi_seg_at(segs, order, i + *n);
+
+		if ((len % QSPI_SEG_WORD_SIZE) || (next->len % QSPI_SEG_WORD_SIZE) ||
+		    (next->addr != seg->addr + len) ||
+		    ((uint8_t *)next->data != (uint8_t *)seg->data + len))
+			break;
+
+		len += next->len;
+	}
+
+	return len;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the reads of RPU spans of any alignment through a
+ * word-aligned bounce buffer for the Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include "qspi_if.h"
+
+#define QSPI_SPAN_WORD_SIZE 4
+
+int qspi_span_read(unsigned int addr, void *data, size_t size, uint32_t *bounce,
+		   size_t bounce_size, qspi_span_read_t read, void *ctx)
+{
+	uint8_t *dptr = data;
+	unsigned int head;
+	size_t len;
+	int ret;
+
+	/* Read the covering aligned span in one transaction and copy out the
+	 * requested bytes. Spans larger than the bounce buffer are split.
+	 */
+	while (size) {
+		head = addr % QSPI_SPAN_WORD_SIZE;
+		len = MIN(size, bounce_size - head);
+
+		ret = read(ctx, addr - head, bounce, ROUND_UP(head + len, QSPI_SPAN_WORD_SIZE));
+		if (ret)
+			return ret;
+
+		memcpy(dptr, (uint8_t *)bounce + head, len);
+
+		addr += len;
+		dptr += len;
+		size -= len;
+	}
+
+	return 0;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the copy out of the memory-mapped QSPI XIP window
+ * for the Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include "qspi_if.h"
+
+#define QSPI_XIP_WORD_SIZE 4
+
+void qspi_xip_copy(const volatile void *window, unsigned int addr, void *data, int len)
+{
+	const volatile uint32_t *src;
+	uint8_t *dst = data;
+	uint32_t val;
+
+	src = (const volatile uint32_t *)((uintptr_t)window + addr);
+
+	/* Word loads, the destination needs no alignment */
+	for (; len > 0; len -= QSPI_XIP_WORD_SIZE) {
+		val = *src++;
+		memcpy(dst, &val, QSPI_XIP_WORD_SIZE);
+		dst += QSPI_XIP_WORD_SIZE;
+	}
+}
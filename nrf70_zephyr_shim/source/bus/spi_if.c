@@ -16,6 +16,7 @@
 
 #include "qspi_if.h"
 #include "spi_if.h"
+#include "bus_trace.h"
 
 LOG_MODULE_DECLARE(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
 
@@ -26,6 +27,49 @@ static struct qspi_config *spim_config;
 static const struct spi_dt_spec spi_spec =
 SPI_DT_SPEC_GET(NRF7002_NODE, SPI_WORD_SET(8) | SPI_TRANSFER_MSB, 0);
 
+/* Two copies of the SPI config for runtime frequency changes, the SPI
+ * drivers only reconfigure the bus when given a different config pointer.
+ */
+static struct spi_config spim_spi_cfg[2];
+static struct spi_config *spim_cur_cfg;
+
+static inline const struct spi_config *spim_spi_config(void)
+{
+	return spim_cur_cfg ? spim_cur_cfg : &spi_spec.config;
+}
+
+static int spim_transceive(const struct spi_buf_set *tx, const struct spi_buf_set *rx)
+{
+	return spi_transceive(spi_spec.bus, spim_spi_config(), tx, rx);
+}
+
+/* Bus transaction bracket, see spim_bus_begin() */
+static k_tid_t spim_bus_owner;
+static int spim_bus_depth;
+
+static inline bool spim_bus_owned(void)
+{
+#ifdef CONFIG_MULTITHREADING
+	return (spim_bus_depth > 0) && (spim_bus_owner == k_current_get());
+#else /* CONFIG_MULTITHREADING */
+	return (spim_bus_depth > 0);
+#endif /* CONFIG_MULTITHREADING */
+}
+
+static inline void spim_lock(void)
+{
+	if (!spim_bus_owned()) {
+		k_sem_take(&spim_config->lock, K_FOREVER);
+	}
+}
+
+static inline void spim_unlock(void)
+{
+	if (!spim_bus_owned()) {
+		k_sem_give(&spim_config->lock);
+	}
+}
+
 static int spim_xfer_tx(unsigned int addr, void *data, unsigned int len)
 {
 	int err;
@@ -43,7 +87,7 @@ static int spim_xfer_tx(unsigned int addr, void *data, unsigned int len)
 	const struct spi_buf_set tx = { .buffers = tx_buf, .count = 2 };
 
 
-	err = spi_transceive_dt(&spi_spec, &tx, NULL);
+	err = spim_transceive(&tx, NULL);
 
 	return err;
 }
@@ -73,7 +117,7 @@ static int spim_xfer_rx(unsigned int addr, void *data, unsigned int len, unsigne
 
 	const struct spi_buf_set rx = { .buffers = rx_buf, .count = 2 };
 
-	return spi_transceive_dt(&spi_spec, &tx, &rx);
+	return spim_transceive(&tx, &rx);
 }
 
 int spim_read_reg(uint32_t reg_addr, uint8_t *reg_value)
@@ -99,7 +143,7 @@ int spim_read_reg(uint32_t reg_addr, uint8_t *reg_value)
 	};
 	const struct spi_buf_set rx = { .buffers = &rx_buf, .count = 1 };
 
-	err = spi_transceive_dt(&spi_spec, &tx, &rx);
+	err = spim_transceive(&tx, &rx);
 
 	LOG_DBG("err: %d -> %x %x %x %x %x %x", err, sr[0], sr[1], sr[2], sr[3], sr[4], sr[5]);
 
@@ -117,7 +161,7 @@ int spim_write_reg(uint32_t reg_addr, const uint8_t reg_value)
 	const struct spi_buf tx_buf = { .buf = tx_buffer, .len = sizeof(tx_buffer) };
 	const struct spi_buf_set tx = { .buffers = &tx_buf, .count = 1 };
 
-	err = spi_transceive_dt(&spi_spec, &tx, NULL);
+	err = spim_transceive(&tx, NULL);
 
 	if (err) {
 		LOG_ERR("SPI error: %d", err);
@@ -129,43 +173,55 @@ int spim_write_reg(uint32_t reg_addr, const uint8_t reg_value)
 
 int spim_RDSR1(const struct device *dev, uint8_t *rdsr1)
 {
-	uint8_t val = 0;
+	uint32_t start = bus_trace_start();
+	int ret = spim_read_reg(0x1F, rdsr1);
+
+	bus_trace_record(BUS_TRACE_RDSR1, 0, 1, ret, start);
 
-	return spim_read_reg(0x1F, &val);
+	return ret;
 }
 
-int spim_RDSR2(const struct device *dev, uint8_t *rdsr1)
+int spim_RDSR2(const struct device *dev, uint8_t *rdsr2)
 {
-	uint8_t val = 0;
+	uint32_t start = bus_trace_start();
+	int ret = spim_read_reg(0x2F, rdsr2);
 
-	return spim_read_reg(0x2F, &val);
+	bus_trace_record(BUS_TRACE_RDSR2, 0, 1, ret, start);
+
+	return ret;
 }
 
 int spim_WRSR2(const struct device *dev, const uint8_t wrsr2)
 {
-	return spim_write_reg(0x3F, wrsr2);
+	uint32_t start = bus_trace_start();
+	int ret = spim_write_reg(0x3F, wrsr2);
+
+	bus_trace_record(BUS_TRACE_WRSR2, 0, 1, ret, start);
+
+	return ret;
 }
 
 int _spim_wait_while_rpu_awake(void)
 {
 	int ret;
 	uint8_t val = 0;
+	uint32_t delay_us = RPU_WAKE_POLL_MIN_US;
+	uint32_t waited_us = 0;
 
-	for (int ii = 0; ii < 10; ii++) {
-
+	while (1) {
 		ret = spim_read_reg(0x1F, &val);
 
 		LOG_DBG("RDSR1 = 0x%x", val);
 
-		if (!ret && (val & RPU_AWAKE_BIT)) {
+		if ((!ret && (val & RPU_AWAKE_BIT)) || (waited_us >= RPU_WAKE_TIMEOUT_US)) {
 			break;
 		}
 
-		k_msleep(1);
+		waited_us += rpu_wake_poll_delay(&delay_us);
 	}
 
 	if (ret || !(val & RPU_AWAKE_BIT)) {
-		LOG_ERR("RPU is not awake even after 10ms");
+		LOG_ERR("RPU is not awake even after %d us", waited_us);
 		return -1;
 	}
 
@@ -177,22 +233,23 @@ int spim_wait_while_rpu_wake_write(void)
 {
 	int ret;
 	uint8_t val = 0;
+	uint32_t delay_us = RPU_WAKE_POLL_MIN_US;
+	uint32_t waited_us = 0;
 
-	for (int ii = 0; ii < 10; ii++) {
-
+	while (1) {
 		ret = spim_read_reg(0x2F, &val);
 
 		LOG_DBG("RDSR2 = 0x%x", val);
 
-		if (!ret && (val & RPU_WAKEUP_NOW)) {
+		if ((!ret && (val & RPU_WAKEUP_NOW)) || (waited_us >= RPU_WAKE_TIMEOUT_US)) {
 			break;
 		}
 
-		k_msleep(1);
+		waited_us += rpu_wake_poll_delay(&delay_us);
 	}
 
 	if (ret || !(val & RPU_WAKEUP_NOW)) {
-		LOG_ERR("RPU wakeup write ACK failed even after 10ms");
+		LOG_ERR("RPU wakeup write ACK failed even after %d us", waited_us);
 		return -1;
 	}
 
@@ -212,7 +269,7 @@ unsigned int spim_cmd_sleep_rpu(void)
 	const struct spi_buf tx_buf = { .buf = tx_buffer, .len = sizeof(tx_buffer) };
 	const struct spi_buf_set tx = { .buffers = &tx_buf, .count = 1 };
 
-	err = spi_transceive_dt(&spi_spec, &tx, NULL);
+	err = spim_transceive(&tx, NULL);
 
 	if (err) {
 		LOG_ERR("SPI error: %d", err);
@@ -243,6 +300,35 @@ int spim_init(struct qspi_config *config)
 	return 0;
 }
 
+int spim_set_freq(uint32_t freq)
+{
+	struct spi_config *next;
+
+	if (!freq) {
+		return -EINVAL;
+	}
+
+	spim_lock();
+
+	next = (spim_cur_cfg == &spim_spi_cfg[0]) ? &spim_spi_cfg[1] : &spim_spi_cfg[0];
+	*next = *spim_spi_config();
+	next->frequency = freq;
+	spim_cur_cfg = next;
+	/* As at init, high-latency reads need a latency word from 16 MHz on */
+	spim_config->qspi_slave_latency = (freq >= MHZ(16)) ? 1 : 0;
+
+	spim_unlock();
+
+	LOG_DBG("SPIM %s: freq = %d Hz", spi_spec.bus->name, freq);
+
+	return 0;
+}
+
+uint32_t spim_get_freq(void)
+{
+	return spim_spi_config()->frequency;
+}
+
 int spim_deinit(void)
 {
 	LOG_DBG("TODO : %s", __func__);
@@ -250,78 +336,318 @@ int spim_deinit(void)
 	return 0;
 }
 
-static void spim_addr_check(unsigned int addr, const void *data, unsigned int len)
+/* SPIM transfers need no host buffer alignment */
+static int spim_addr_check(unsigned int addr, const void *data, unsigned int len)
 {
-	if ((addr % 4 != 0) || (((unsigned int)data) % 4 != 0) || (len % 4 != 0)) {
+	if ((addr % 4 != 0) || (len % 4 != 0)) {
 		LOG_ERR("%s : Unaligned address %x %x %d %x %x", __func__, addr,
 		       (unsigned int)data, (addr % 4 != 0), (((unsigned int)data) % 4 != 0),
 		       (len % 4 != 0));
+		return -EINVAL;
 	}
+
+	return 0;
 }
 
 int spim_write(unsigned int addr, const void *data, int len)
 {
+	uint32_t start = bus_trace_start();
 	int status;
 
-	spim_addr_check(addr, data, len);
+	status = spim_addr_check(addr, data, len);
+
+	if (status) {
+		return status;
+	}
 
 	addr |= spim_config->addrmask;
 
-	k_sem_take(&spim_config->lock, K_FOREVER);
+	spim_lock();
 
 	status = spim_xfer_tx(addr, (void *)data, len);
 
-	k_sem_give(&spim_config->lock);
+	spim_unlock();
+
+	bus_trace_record(BUS_TRACE_WRITE, addr, len, status, start);
 
 	return status;
 }
 
 int spim_read(unsigned int addr, void *data, int len)
 {
+	uint32_t start = bus_trace_start();
 	int status;
 
-	spim_addr_check(addr, data, len);
+	status = spim_addr_check(addr, data, len);
+
+	if (status) {
+		return status;
+	}
 
 	addr |= spim_config->addrmask;
 
-	k_sem_take(&spim_config->lock, K_FOREVER);
+	spim_lock();
 
 	status = spim_xfer_rx(addr, data, len, 0);
 
-	k_sem_give(&spim_config->lock);
+	spim_unlock();
+
+	bus_trace_record(BUS_TRACE_READ, addr, len, status, start);
 
 	return status;
 }
 
-static int spim_hl_readw(unsigned int addr, void *data)
+/* Each segment is its own header + data buffer chain, all segments are
+ * transferred under a single lock.
+ */
+int spim_readv(const struct qspi_seg *segs, int count)
+{
+	uint32_t start = bus_trace_start();
+	int status = 0;
+	int len = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (spim_addr_check(segs[i].addr, segs[i].data, segs[i].len)) {
+			return -EINVAL;
+		}
+	}
+
+	spim_lock();
+
+	for (i = 0; (i < count) && !status; i++) {
+		len += segs[i].len;
+
+		status = spim_xfer_rx(segs[i].addr | spim_config->addrmask, segs[i].data,
+				      segs[i].len, 0);
+	}
+
+	spim_unlock();
+
+	bus_trace_record(BUS_TRACE_READV, count ? segs[0].addr : 0, len, status, start);
+
+	return status;
+}
+
+int spim_writev(const struct qspi_seg *segs, int count)
+{
+	uint32_t start = bus_trace_start();
+	int status = 0;
+	int len = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (spim_addr_check(segs[i].addr, segs[i].data, segs[i].len)) {
+			return -EINVAL;
+		}
+	}
+
+	spim_lock();
+
+	for (i = 0; (i < count) && !status; i++) {
+		len += segs[i].len;
+
+		status = spim_xfer_tx(segs[i].addr | spim_config->addrmask, segs[i].data,
+				      segs[i].len);
+	}
+
+	spim_unlock();
+
+	bus_trace_record(BUS_TRACE_WRITEV, count ? segs[0].addr : 0, len, status, start);
+
+	return status;
+}
+
+#ifdef CONFIG_NRF700X_BUS_ASYNC
+static void spim_async_work_handler(struct k_work *work)
+{
+	struct qspi_async_xfer *xfer = CONTAINER_OF(work, struct qspi_async_xfer, work);
+
+	/* Inside a bus transaction the owner keeps the lock */
+	if (!xfer->in_bus_txn) {
+		k_sem_give(&spim_config->lock);
+	}
+
+	if (xfer->cb) {
+		xfer->cb(xfer);
+	}
+
+	/* Last access to xfer, the waiter may release it */
+	k_sem_give(&xfer->done);
+}
+
+static void spim_async_done(const struct device *dev, int result, void *data)
+{
+	struct qspi_async_xfer *xfer = data;
+
+	xfer->status = result;
+
+	/* Called from the SPI ISR, complete in thread context */
+	k_work_submit(&xfer->work);
+}
+
+int spim_submit(struct qspi_async_xfer *xfer)
+{
+	int err;
+	unsigned int addr;
+
+	if (!xfer->data || (xfer->len <= 0)) {
+		return -EINVAL;
+	}
+
+	if (spim_addr_check(xfer->addr, xfer->data, xfer->len)) {
+		return -EINVAL;
+	}
+
+	addr = xfer->addr | spim_config->addrmask;
+
+	k_work_init(&xfer->work, spim_async_work_handler);
+	k_sem_init(&xfer->done, 0, 1);
+
+	/* Header and buffer descriptors live in xfer until completion */
+	if (xfer->write) {
+		xfer->hdr[0] = 0x02; /* PP opcode */
+		xfer->hdr[1] = (((addr >> 16) & 0xFF) | 0x80);
+		xfer->hdr[2] = (addr >> 8) & 0xFF;
+		xfer->hdr[3] = (addr & 0xFF);
+
+		xfer->tx_bufs[0].buf = xfer->hdr;
+		xfer->tx_bufs[0].len = 4;
+		xfer->tx_bufs[1].buf = xfer->data;
+		xfer->tx_bufs[1].len = xfer->len;
+	} else {
+		xfer->hdr[0] = 0x0b; /* FASTREAD opcode */
+		xfer->hdr[1] = (addr >> 16) & 0xFF;
+		xfer->hdr[2] = (addr >> 8) & 0xFF;
+		xfer->hdr[3] = addr & 0xFF;
+		xfer->hdr[4] = 0; /* dummy byte */
+
+		xfer->tx_bufs[0].buf = xfer->hdr;
+		xfer->tx_bufs[0].len = sizeof(xfer->hdr);
+		xfer->tx_bufs[1].buf = NULL;
+		xfer->tx_bufs[1].len = xfer->len;
+
+		xfer->rx_bufs[0].buf = NULL;
+		xfer->rx_bufs[0].len = sizeof(xfer->hdr);
+		xfer->rx_bufs[1].buf = xfer->data;
+		xfer->rx_bufs[1].len = xfer->len;
+	}
+
+	xfer->tx.buffers = xfer->tx_bufs;
+	xfer->tx.count = ARRAY_SIZE(xfer->tx_bufs);
+	xfer->rx.buffers = xfer->rx_bufs;
+	xfer->rx.count = ARRAY_SIZE(xfer->rx_bufs);
+	xfer->in_bus_txn = spim_bus_owned();
+
+	spim_lock();
+
+	err = spi_transceive_cb(spi_spec.bus, spim_spi_config(), &xfer->tx,
+				xfer->write ? NULL : &xfer->rx, spim_async_done, xfer);
+	if (err) {
+		spim_unlock();
+	}
+
+	return err;
+}
+#endif /* CONFIG_NRF700X_BUS_ASYNC */
+
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+#define SPIM_HL_BURST_WORDS CONFIG_NRF700X_HL_READ_BURST_MAX_WORDS
+
+/* Bursts are only used once verified on the hardware */
+static bool spim_hl_burst;
+
+void spim_hl_burst_set(bool enable)
+{
+	spim_lock();
+	spim_hl_burst = enable;
+	spim_unlock();
+}
+#else
+#define SPIM_HL_BURST_WORDS 1
+#define spim_hl_burst false
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+
+static int spim_hl_read_words(unsigned int addr, void *data, int nwords, unsigned int latency)
 {
 	int status = -1;
 
-	k_sem_take(&spim_config->lock, K_FOREVER);
+	/* A burst relies on the RPU incrementing the address after the
+	 * latency words, a single word is read in fixed address mode.
+	 */
+	if (nwords > 1) {
+		addr |= spim_config->addrmask;
+	}
 
-	status = spim_xfer_rx(addr, data, 4, 4 * spim_config->qspi_slave_latency);
+	spim_lock();
 
-	k_sem_give(&spim_config->lock);
+	status = spim_xfer_rx(addr, data, 4 * nwords, 4 * latency);
+
+	spim_unlock();
 
 	return status;
 }
 
-int spim_hl_read(unsigned int addr, void *data, int len)
+int spim_hl_read(unsigned int addr, void *data, int len, unsigned int latency)
 {
+	uint32_t start = bus_trace_start();
 	int count = 0;
+	int nwords;
+	int status;
+
+	/* Reads are done in whole words */
+	status = spim_addr_check(addr, data, len);
 
-	spim_addr_check(addr, data, len);
+	while (!status && (count < (len / 4))) {
+		nwords = spim_hl_burst ? MIN((len / 4) - count, SPIM_HL_BURST_WORDS) : 1;
 
-	while (count < (len / 4)) {
-		spim_hl_readw(addr + (4 * count), (char *)data + (4 * count));
-		count++;
+		status = spim_hl_read_words(addr + (4 * count), (char *)data + (4 * count),
+					    nwords, latency);
+		if (status) {
+			break;
+		}
+
+		count += nwords;
 	}
 
-	return 0;
+	bus_trace_record(BUS_TRACE_HL_READ, addr, len, status, start);
+
+	return status;
 }
 
 /* ------------------------------added for wifi utils -------------------------------- */
 
+int spim_bus_begin(void)
+{
+	if (spim_bus_owned()) {
+		spim_bus_depth++;
+		return 0;
+	}
+
+	k_sem_take(&spim_config->lock, K_FOREVER);
+
+	spim_bus_owner = k_current_get();
+	spim_bus_depth = 1;
+
+	return 0;
+}
+
+void spim_bus_end(void)
+{
+	if (!spim_bus_owned()) {
+		LOG_ERR("%s: Bus not held by caller", __func__);
+		return;
+	}
+
+	if (--spim_bus_depth > 0) {
+		return;
+	}
+
+	spim_bus_owner = NULL;
+
+	k_sem_give(&spim_config->lock);
+}
+
 int spim_cmd_rpu_wakeup_fn(uint32_t data)
 {
 	return spim_cmd_rpu_wakeup(data);
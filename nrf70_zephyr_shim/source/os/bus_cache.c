@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the posted writes and the read cache of RPU
+ * memory accesses for the Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "rpu_hw_if.h"
+#include "shim.h"
+#include "bus_cache.h"
+
+LOG_MODULE_DECLARE(wifi_nrf, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
+
+#ifdef CONFIG_NRF700X_POSTED_WRITES
+BUILD_ASSERT((CONFIG_NRF700X_POSTED_WRITES_SIZE % 4) == 0,
+	     "Posted write buffer size must be a multiple of 4");
+
+#define ZEP_SHIM_PW_WORDS (CONFIG_NRF700X_POSTED_WRITES_SIZE / 4)
+
+/* Run of posted writes to consecutive word addresses, written to the bus
+ * in one burst when flushed.
+ */
+static struct {
+	struct qspi_dev *dev;
+	unsigned long addr;
+	unsigned int nwords;
+	uint32_t buf[ZEP_SHIM_PW_WORDS];
+	struct zep_shim_pw_stats stats;
+} zep_shim_pw;
+
+static K_SEM_DEFINE(zep_shim_pw_lock, 1, 1);
+
+static void zep_shim_pw_flush_locked(void)
+{
+	int ret;
+
+	if (!zep_shim_pw.nwords) {
+		return;
+	}
+
+	ret = ZEP_SHIM_BUS_OP(zep_shim_pw.dev, write)(zep_shim_pw.addr, zep_shim_pw.buf,
+						      zep_shim_pw.nwords * 4);
+	if (ret) {
+		/* The writers have returned already, nobody else can report it */
+		LOG_ERR("%s: Posted write of %d words at 0x%lx failed: %d", __func__,
+			zep_shim_pw.nwords, zep_shim_pw.addr, ret);
+		zep_shim_pw.stats.errors++;
+	}
+
+	zep_shim_pw.stats.flushes++;
+	zep_shim_pw.nwords = 0;
+}
+
+void zep_shim_pw_flush(void)
+{
+	k_sem_take(&zep_shim_pw_lock, K_FOREVER);
+	zep_shim_pw_flush_locked();
+	k_sem_give(&zep_shim_pw_lock);
+}
+
+static void zep_shim_pw_flush_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	zep_shim_pw_flush();
+}
+
+static K_WORK_DELAYABLE_DEFINE(zep_shim_pw_flush_work, zep_shim_pw_flush_work_handler);
+
+void zep_shim_pw_post(struct qspi_dev *dev, unsigned long addr, const void *src,
+		      unsigned int nwords)
+{
+	k_sem_take(&zep_shim_pw_lock, K_FOREVER);
+
+	if (zep_shim_pw.nwords &&
+	    ((addr != zep_shim_pw.addr + zep_shim_pw.nwords * 4) ||
+	     (zep_shim_pw.nwords + nwords > ZEP_SHIM_PW_WORDS))) {
+		zep_shim_pw_flush_locked();
+	}
+
+	if (zep_shim_pw.nwords) {
+		zep_shim_pw.stats.combined++;
+	} else {
+		zep_shim_pw.dev = dev;
+		zep_shim_pw.addr = addr;
+
+		/* Bound the time a write can stay posted */
+		k_work_reschedule(&zep_shim_pw_flush_work,
+				  K_USEC(CONFIG_NRF700X_POSTED_WRITES_TIMEOUT_US));
+	}
+
+	memcpy(&zep_shim_pw.buf[zep_shim_pw.nwords], src, nwords * 4);
+	zep_shim_pw.nwords += nwords;
+	zep_shim_pw.stats.posted++;
+
+	k_sem_give(&zep_shim_pw_lock);
+}
+
+void zep_shim_pw_stats_get(struct zep_shim_pw_stats *stats)
+{
+	k_sem_take(&zep_shim_pw_lock, K_FOREVER);
+	*stats = zep_shim_pw.stats;
+	k_sem_give(&zep_shim_pw_lock);
+}
+#endif /* CONFIG_NRF700X_POSTED_WRITES */
+
+#ifdef CONFIG_NRF700X_READ_CACHE
+#define ZEP_SHIM_RC_LINE_SIZE 32
+#define ZEP_SHIM_RC_LINES CONFIG_NRF700X_READ_CACHE_LINES
+
+struct zep_shim_rc_line {
+	unsigned long addr;
+	atomic_val_t gen;
+	bool valid;
+	uint32_t data[ZEP_SHIM_RC_LINE_SIZE / 4];
+};
+
+/* Direct mapped cache of RPU memory lines */
+static struct zep_shim_rc_line zep_shim_rc[ZEP_SHIM_RC_LINES];
+static struct zep_shim_rc_stats zep_shim_rc_stats;
+
+/* Bumped on every host interrupt, lines filled in an older generation are
+ * stale as the RPU may have updated its memory before interrupting.
+ */
+static atomic_t zep_shim_rc_gen;
+
+/* Set while the host interrupt is registered, without it nothing would
+ * invalidate the lines the RPU updates.
+ */
+static bool zep_shim_rc_enabled;
+
+static K_SEM_DEFINE(zep_shim_rc_lock, 1, 1);
+
+void zep_shim_rc_invalidate_all(void)
+{
+	atomic_inc(&zep_shim_rc_gen);
+}
+
+void zep_shim_rc_enable(bool enable)
+{
+	zep_shim_rc_invalidate_all();
+	zep_shim_rc_enabled = enable;
+}
+
+void zep_shim_rc_invalidate(unsigned long addr, size_t count)
+{
+	unsigned int i;
+
+	k_sem_take(&zep_shim_rc_lock, K_FOREVER);
+
+	for (i = 0; i < ZEP_SHIM_RC_LINES; i++) {
+		struct zep_shim_rc_line *line = &zep_shim_rc[i];
+
+		if (line->valid && (addr < line->addr + ZEP_SHIM_RC_LINE_SIZE) &&
+		    (line->addr < addr + count)) {
+			line->valid = false;
+		}
+	}
+
+	k_sem_give(&zep_shim_rc_lock);
+}
+
+static int zep_shim_rc_fill(struct qspi_dev *dev, struct zep_shim_rc_line *line,
+			    unsigned long addr)
+{
+	atomic_val_t gen = atomic_get(&zep_shim_rc_gen);
+	struct rpu_access acc;
+	int ret;
+
+	if (rpu_plan(addr, sizeof(line->data), &acc)) {
+		return -EINVAL;
+	}
+
+	if (acc.hl) {
+		ret = ZEP_SHIM_BUS_OP(dev, hl_read)(addr, line->data, sizeof(line->data),
+						    acc.latency);
+	} else {
+		ret = ZEP_SHIM_BUS_OP(dev, read)(addr, line->data, sizeof(line->data));
+	}
+
+	line->addr = addr;
+	line->gen = gen;
+	line->valid = (ret == 0);
+
+	return ret;
+}
+
+bool zep_shim_rc_read(struct qspi_dev *dev, unsigned long addr, void *dest, size_t count)
+{
+	unsigned long start = ROUND_DOWN(addr, ZEP_SHIM_RC_LINE_SIZE);
+	unsigned long end = addr + count;
+	unsigned char *out = dest;
+	unsigned long line_addr;
+	bool ret = true;
+
+	if (!zep_shim_rc_enabled || !count || (count > ZEP_SHIM_RC_LINE_SIZE) ||
+	    !rpu_addr_cacheable(start, ROUND_UP(end, ZEP_SHIM_RC_LINE_SIZE) - start)) {
+		return false;
+	}
+
+	k_sem_take(&zep_shim_rc_lock, K_FOREVER);
+
+	for (line_addr = start; line_addr < end; line_addr += ZEP_SHIM_RC_LINE_SIZE) {
+		struct zep_shim_rc_line *line =
+			&zep_shim_rc[(line_addr / ZEP_SHIM_RC_LINE_SIZE) % ZEP_SHIM_RC_LINES];
+		size_t off = MAX(addr, line_addr) - line_addr;
+		size_t len = MIN(end, line_addr + ZEP_SHIM_RC_LINE_SIZE) - line_addr - off;
+
+		if (line->valid && (line->addr == line_addr) &&
+		    (line->gen == atomic_get(&zep_shim_rc_gen))) {
+			zep_shim_rc_stats.hits++;
+		} else {
+			zep_shim_rc_stats.misses++;
+
+			if (zep_shim_rc_fill(dev, line, line_addr)) {
+				ret = false;
+				break;
+			}
+		}
+
+		memcpy(out, (unsigned char *)line->data + off, len);
+		out += len;
+	}
+
+	k_sem_give(&zep_shim_rc_lock);
+
+	return ret;
+}
+
+void zep_shim_rc_stats_get(struct zep_shim_rc_stats *stats)
+{
+	k_sem_take(&zep_shim_rc_lock, K_FOREVER);
+	*stats = zep_shim_rc_stats;
+	k_sem_give(&zep_shim_rc_lock);
+}
+#endif /* CONFIG_NRF700X_READ_CACHE */
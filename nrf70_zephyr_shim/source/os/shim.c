@@ -25,21 +25,295 @@
 #include "timer.h"
 #include "osal_ops.h"
 #include "qspi_if.h"
+#include "bus_cache.h"
 
 LOG_MODULE_REGISTER(wifi_nrf, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
 
 struct zep_shim_intr_priv *intr_priv;
 
-static void *zep_shim_mem_alloc(size_t size)
+#ifdef CONFIG_NRF700X_MEM_ARENA
+/* Everything the driver allocates lives in its own heap, deinit drops the
+ * arena as a whole instead of relying on every block being freed.
+ */
+K_HEAP_DEFINE(zep_shim_arena, CONFIG_NRF700X_MEM_ARENA_SIZE);
+
+/* Serializes the arena reset against the allocations and frees from the
+ * arena, the memory slabs and the network buffer pools. Allocations can
+ * come from interrupt context.
+ */
+static struct k_spinlock zep_shim_arena_lock;
+
+/* Set by the bus deinit, which releases everything the driver instance
+ * allocated. The FMAC layer still reads and frees its private data after
+ * the bus deinit, so the memory is only re-initialized when the next
+ * instance allocates. Frees in between are dropped, those blocks went
+ * with the release.
+ */
+static bool zep_shim_arena_released;
+
+static void zep_shim_mem_arena_reset(void);
+static void zep_shim_mem_arena_release(void);
+
+static inline void zep_shim_arena_check(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&zep_shim_arena_lock);
+
+	if (zep_shim_arena_released) {
+		zep_shim_mem_arena_reset();
+		zep_shim_arena_released = false;
+	}
+
+	k_spin_unlock(&zep_shim_arena_lock, key);
+}
+
+/* Returns false if the block to free went with the release, the arena is
+ * locked until zep_shim_arena_free_end() either way.
+ */
+static inline bool zep_shim_arena_free_begin(k_spinlock_key_t *key)
+{
+	*key = k_spin_lock(&zep_shim_arena_lock);
+
+	return !zep_shim_arena_released;
+}
+
+static inline void zep_shim_arena_free_end(k_spinlock_key_t key)
+{
+	k_spin_unlock(&zep_shim_arena_lock, key);
+}
+
+static void *zep_shim_heap_alloc(size_t size)
+{
+	k_spinlock_key_t key;
+	void *ptr;
+
+	zep_shim_arena_check();
+
+	key = k_spin_lock(&zep_shim_arena_lock);
+	ptr = k_heap_alloc(&zep_shim_arena, size, K_NO_WAIT);
+	k_spin_unlock(&zep_shim_arena_lock, key);
+
+	return ptr;
+}
+
+static void zep_shim_heap_free(void *ptr)
+{
+	k_spinlock_key_t key;
+
+	if (zep_shim_arena_free_begin(&key)) {
+		k_heap_free(&zep_shim_arena, ptr);
+	}
+
+	zep_shim_arena_free_end(key);
+}
+#else
+static inline void zep_shim_arena_check(void)
+{
+}
+
+static inline bool zep_shim_arena_free_begin(k_spinlock_key_t *key)
+{
+	ARG_UNUSED(key);
+
+	return true;
+}
+
+static inline void zep_shim_arena_free_end(k_spinlock_key_t key)
+{
+	ARG_UNUSED(key);
+}
+
+static void *zep_shim_heap_alloc(size_t size)
 {
-	size = (size + 4) & 0xfffffffc;
 	return k_malloc(size);
 }
 
+static void zep_shim_heap_free(void *ptr)
+{
+	k_free(ptr);
+}
+#endif /* CONFIG_NRF700X_MEM_ARENA */
+
+static void *zep_shim_heap_zalloc(size_t size)
+{
+	void *ptr = zep_shim_heap_alloc(size);
+
+	if (ptr) {
+		memset(ptr, 0, size);
+	}
+
+	return ptr;
+}
+
+#ifdef CONFIG_NRF700X_MEM_SLAB
+BUILD_ASSERT(((CONFIG_NRF700X_MEM_SLAB_CLASS0_SIZE % 4) == 0) &&
+	     ((CONFIG_NRF700X_MEM_SLAB_CLASS1_SIZE % 4) == 0) &&
+	     ((CONFIG_NRF700X_MEM_SLAB_CLASS2_SIZE % 4) == 0) &&
+	     ((CONFIG_NRF700X_MEM_SLAB_CLASS3_SIZE % 4) == 0),
+	     "Slab class sizes must be multiples of 4");
+BUILD_ASSERT((CONFIG_NRF700X_MEM_SLAB_CLASS0_SIZE < CONFIG_NRF700X_MEM_SLAB_CLASS1_SIZE) &&
+	     (CONFIG_NRF700X_MEM_SLAB_CLASS1_SIZE < CONFIG_NRF700X_MEM_SLAB_CLASS2_SIZE) &&
+	     (CONFIG_NRF700X_MEM_SLAB_CLASS2_SIZE < CONFIG_NRF700X_MEM_SLAB_CLASS3_SIZE),
+	     "Slab class sizes must be increasing");
+
+K_MEM_SLAB_DEFINE_STATIC(zep_shim_slab0, CONFIG_NRF700X_MEM_SLAB_CLASS0_SIZE,
+			 CONFIG_NRF700X_MEM_SLAB_CLASS0_BLOCKS, 4);
+K_MEM_SLAB_DEFINE_STATIC(zep_shim_slab1, CONFIG_NRF700X_MEM_SLAB_CLASS1_SIZE,
+			 CONFIG_NRF700X_MEM_SLAB_CLASS1_BLOCKS, 4);
+K_MEM_SLAB_DEFINE_STATIC(zep_shim_slab2, CONFIG_NRF700X_MEM_SLAB_CLASS2_SIZE,
+			 CONFIG_NRF700X_MEM_SLAB_CLASS2_BLOCKS, 4);
+K_MEM_SLAB_DEFINE_STATIC(zep_shim_slab3, CONFIG_NRF700X_MEM_SLAB_CLASS3_SIZE,
+			 CONFIG_NRF700X_MEM_SLAB_CLASS3_BLOCKS, 4);
+
+static struct k_mem_slab *const zep_shim_slabs[ZEP_SHIM_SLAB_CLASSES] = {
+	&zep_shim_slab0, &zep_shim_slab1, &zep_shim_slab2, &zep_shim_slab3,
+};
+
+static struct zep_shim_slab_stats zep_shim_slab_stats[ZEP_SHIM_SLAB_CLASSES] = {
+	{ CONFIG_NRF700X_MEM_SLAB_CLASS0_SIZE, CONFIG_NRF700X_MEM_SLAB_CLASS0_BLOCKS },
+	{ CONFIG_NRF700X_MEM_SLAB_CLASS1_SIZE, CONFIG_NRF700X_MEM_SLAB_CLASS1_BLOCKS },
+	{ CONFIG_NRF700X_MEM_SLAB_CLASS2_SIZE, CONFIG_NRF700X_MEM_SLAB_CLASS2_BLOCKS },
+	{ CONFIG_NRF700X_MEM_SLAB_CLASS3_SIZE, CONFIG_NRF700X_MEM_SLAB_CLASS3_BLOCKS },
+};
+
+static uint32_t zep_shim_slab_large;
+
+/* Allocations can come from interrupt context */
+static struct k_spinlock zep_shim_slab_lock;
+
+static void *zep_shim_slab_alloc(size_t size)
+{
+	struct zep_shim_slab_stats *stats;
+	k_spinlock_key_t key;
+	void *ptr = NULL;
+	int i;
+
+	zep_shim_arena_check();
+
+	for (i = 0; i < ZEP_SHIM_SLAB_CLASSES; i++) {
+		if (size <= zep_shim_slab_stats[i].size) {
+			break;
+		}
+	}
+
+	if (i == ZEP_SHIM_SLAB_CLASSES) {
+		key = k_spin_lock(&zep_shim_slab_lock);
+		zep_shim_slab_large++;
+		k_spin_unlock(&zep_shim_slab_lock, key);
+		return zep_shim_heap_alloc(size);
+	}
+
+	if (k_mem_slab_alloc(zep_shim_slabs[i], &ptr, K_NO_WAIT)) {
+		ptr = NULL;
+	}
+
+	stats = &zep_shim_slab_stats[i];
+
+	key = k_spin_lock(&zep_shim_slab_lock);
+	if (ptr) {
+		stats->allocs++;
+		stats->used++;
+		stats->peak = MAX(stats->peak, stats->used);
+	} else {
+		stats->exhausted++;
+	}
+	k_spin_unlock(&zep_shim_slab_lock, key);
+
+	return ptr ? ptr : zep_shim_heap_alloc(size);
+}
+
+static void zep_shim_mem_free(void *ptr)
+{
+	struct k_mem_slab *slab;
+	k_spinlock_key_t key;
+	bool live;
+	char *buf;
+	int i;
+
+	/* The block address tells which slab, if any, it was taken from */
+	for (i = 0; i < ZEP_SHIM_SLAB_CLASSES; i++) {
+		slab = zep_shim_slabs[i];
+		buf = slab->buffer;
+
+		if (((char *)ptr >= buf) &&
+		    ((char *)ptr < buf + (zep_shim_slab_stats[i].size *
+					  zep_shim_slab_stats[i].blocks))) {
+			live = zep_shim_arena_free_begin(&key);
+			if (live) {
+				k_mem_slab_free(slab, ptr);
+			}
+			zep_shim_arena_free_end(key);
+
+			if (!live) {
+				return;
+			}
+
+			key = k_spin_lock(&zep_shim_slab_lock);
+			zep_shim_slab_stats[i].used--;
+			k_spin_unlock(&zep_shim_slab_lock, key);
+			return;
+		}
+	}
+
+	zep_shim_heap_free(ptr);
+}
+
+void zep_shim_slab_stats_get(struct zep_shim_slab_stats *stats, uint32_t *large)
+{
+	k_spinlock_key_t key = k_spin_lock(&zep_shim_slab_lock);
+
+	memcpy(stats, zep_shim_slab_stats, sizeof(zep_shim_slab_stats));
+	*large = zep_shim_slab_large;
+
+	k_spin_unlock(&zep_shim_slab_lock, key);
+}
+
+static inline void zep_shim_slab_reset(void)
+{
+	k_spinlock_key_t key;
+	int i;
+
+	for (i = 0; i < ZEP_SHIM_SLAB_CLASSES; i++) {
+		k_mem_slab_init(zep_shim_slabs[i], zep_shim_slabs[i]->buffer,
+				zep_shim_slab_stats[i].size, zep_shim_slab_stats[i].blocks);
+
+		key = k_spin_lock(&zep_shim_slab_lock);
+		zep_shim_slab_stats[i].used = 0;
+		k_spin_unlock(&zep_shim_slab_lock, key);
+	}
+}
+#else
+static inline void *zep_shim_slab_alloc(size_t size)
+{
+	return zep_shim_heap_alloc(size);
+}
+
+static void zep_shim_mem_free(void *ptr)
+{
+	zep_shim_heap_free(ptr);
+}
+
+static inline void zep_shim_slab_reset(void)
+{
+}
+#endif /* CONFIG_NRF700X_MEM_SLAB */
+
+static void *zep_shim_mem_alloc(size_t size)
+{
+	return zep_shim_slab_alloc(ROUND_UP(size, 4));
+}
+
 static void *zep_shim_mem_zalloc(size_t size)
 {
-	size = (size + 4) & 0xfffffffc;
-	return k_calloc(size, sizeof(char));
+	void *ptr;
+
+	size = ROUND_UP(size, 4);
+
+	ptr = zep_shim_slab_alloc(size);
+	if (ptr) {
+		memset(ptr, 0, size);
+	}
+
+	return ptr;
 }
 
 static void *zep_shim_mem_cpy(void *dest, const void *src, size_t count)
@@ -59,18 +333,56 @@ static int zep_shim_mem_cmp(const void *addr1,
 	return memcmp(addr1, addr2, size);
 }
 
+#ifdef CONFIG_NRF700X_QSPI_XIP
+static inline bool zep_shim_xip_capable(struct qspi_dev *dev, const struct rpu_access *acc)
+{
+	return dev->xip_read && acc->xip;
+}
+
+static inline int zep_shim_xip_read(struct qspi_dev *dev, unsigned long addr, void *data,
+				    size_t len)
+{
+	return dev->xip_read(addr, data, len);
+}
+#else
+static inline bool zep_shim_xip_capable(struct qspi_dev *dev, const struct rpu_access *acc)
+{
+	return false;
+}
+
+static inline int zep_shim_xip_read(struct qspi_dev *dev, unsigned long addr, void *data,
+				    size_t len)
+{
+	return -ENOTSUP;
+}
+#endif /* CONFIG_NRF700X_QSPI_XIP */
+
 static unsigned int zep_shim_qspi_read_reg32(void *priv, unsigned long addr)
 {
-	unsigned int val;
+	unsigned int val = 0;
 	struct zep_shim_bus_qspi_priv *qspi_priv = priv;
+	struct rpu_access acc;
 	struct qspi_dev *dev;
 
 	dev = qspi_priv->qspi_dev;
 
-	if (addr < 0x0C0000) {
-		dev->hl_read(addr, &val, 4);
+	zep_shim_pw_flush();
+
+	if (zep_shim_rc_read(dev, addr, &val, 4)) {
+		return val;
+	}
+
+	if (rpu_plan(addr, 4, &acc)) {
+		LOG_ERR("%s: Invalid RPU address 0x%lx", __func__, addr);
+		return val;
+	}
+
+	if (acc.hl) {
+		ZEP_SHIM_BUS_OP(dev, hl_read)(addr, &val, 4, acc.latency);
+	} else if (zep_shim_xip_capable(dev, &acc)) {
+		zep_shim_xip_read(dev, addr, &val, 4);
 	} else {
-		dev->read(addr, &val, 4);
+		ZEP_SHIM_BUS_OP(dev, read)(addr, &val, 4);
 	}
 
 	return val;
@@ -83,24 +395,103 @@ static void zep_shim_qspi_write_reg32(void *priv, unsigned long addr, unsigned i
 
 	dev = qspi_priv->qspi_dev;
 
-	dev->write(addr, &val, 4);
+	zep_shim_rc_invalidate(addr, 4);
+
+#ifdef CONFIG_NRF700X_POSTED_WRITES
+	/* SYSBUS holds the interrupt trigger and acknowledge registers, the
+	 * RPU must see those without the posting delay.
+	 */
+	if (!(addr & 0x3) && (addr > rpu_7002_memmap[SYSBUS][1])) {
+		zep_shim_pw_post(dev, addr, &val, 1);
+		return;
+	}
+
+	/* Ordered after the posted writes */
+	zep_shim_pw_flush();
+#endif /* CONFIG_NRF700X_POSTED_WRITES */
+
+	ZEP_SHIM_BUS_OP(dev, write)(addr, &val, 4);
+}
+
+/* Read count bytes within one memory block */
+static void zep_shim_qspi_read_blk(struct qspi_dev *dev, const struct rpu_access *acc,
+				   unsigned long addr, void *dest, size_t count)
+{
+	struct qspi_seg segs[2];
+	size_t body = count & ~0x3;
+	unsigned int tail = 0;
+	int nsegs = 0;
+
+	/* Bus reads are in words, read a trailing partial word separately
+	 * so that it does not overrun dest.
+	 */
+	if (acc->hl) {
+		if (body) {
+			ZEP_SHIM_BUS_OP(dev, hl_read)(addr, dest, body, acc->latency);
+		}
+
+		if (count != body) {
+			ZEP_SHIM_BUS_OP(dev, hl_read)(addr + body, &tail, 4, acc->latency);
+		}
+	} else if (zep_shim_xip_capable(dev, acc)) {
+		if (body) {
+			zep_shim_xip_read(dev, addr, dest, body);
+		}
+
+		if (count != body) {
+			zep_shim_xip_read(dev, addr + body, &tail, 4);
+		}
+	} else {
+		if (body) {
+			segs[nsegs].addr = addr;
+			segs[nsegs].data = dest;
+			segs[nsegs].len = body;
+			nsegs++;
+		}
+
+		if (count != body) {
+			segs[nsegs].addr = addr + body;
+			segs[nsegs].data = &tail;
+			segs[nsegs].len = 4;
+			nsegs++;
+		}
+
+		ZEP_SHIM_BUS_OP(dev, readv)(segs, nsegs);
+	}
+
+	if (count != body) {
+		memcpy((unsigned char *)dest + body, &tail, count - body);
+	}
 }
 
 static void zep_shim_qspi_cpy_from(void *priv, void *dest, unsigned long addr, size_t count)
 {
 	struct zep_shim_bus_qspi_priv *qspi_priv = priv;
+	struct rpu_access acc;
 	struct qspi_dev *dev;
 
 	dev = qspi_priv->qspi_dev;
 
-	if (count % 4 != 0) {
-		count = (count + 4) & 0xfffffffc;
+	zep_shim_pw_flush();
+
+	if (zep_shim_rc_read(dev, addr, dest, count)) {
+		return;
 	}
 
-	if (addr < 0x0C0000) {
-		dev->hl_read(addr, dest, count);
-	} else {
-		dev->read(addr, dest, count);
+	/* Reads crossing memory blocks are split, each part is done with the
+	 * access type of its block.
+	 */
+	while (count) {
+		if (rpu_plan(addr, count, &acc)) {
+			LOG_ERR("%s: Invalid RPU address 0x%lx", __func__, addr);
+			return;
+		}
+
+		zep_shim_qspi_read_blk(dev, &acc, addr, dest, acc.len);
+
+		addr += acc.len;
+		dest = (unsigned char *)dest + acc.len;
+		count -= acc.len;
 	}
 }
 
@@ -108,21 +499,53 @@ static void zep_shim_qspi_cpy_to(void *priv, unsigned long addr, const void *src
 {
 	struct zep_shim_bus_qspi_priv *qspi_priv = priv;
 	struct qspi_dev *dev;
+	struct qspi_seg segs[2];
+	size_t body = count & ~0x3;
+	unsigned int tail = 0;
+	int nsegs = 0;
 
 	dev = qspi_priv->qspi_dev;
 
-	if (count % 4 != 0) {
-		count = (count + 4) & 0xfffffffc;
+	zep_shim_rc_invalidate(addr, count);
+
+#ifdef CONFIG_NRF700X_POSTED_WRITES
+	/* Small word aligned copies are combined like register writes */
+	if (!(addr & 0x3) && !(count & 0x3) && count &&
+	    (count <= CONFIG_NRF700X_POSTED_WRITES_SIZE)) {
+		zep_shim_pw_post(dev, addr, src, count / 4);
+		return;
+	}
+
+	zep_shim_pw_flush();
+#endif /* CONFIG_NRF700X_POSTED_WRITES */
+
+	/* A trailing partial word is zero padded to a full word in a
+	 * separate segment so that src is not overrun.
+	 */
+	if (body) {
+		segs[nsegs].addr = addr;
+		segs[nsegs].data = (void *)src;
+		segs[nsegs].len = body;
+		nsegs++;
+	}
+
+	if (count != body) {
+		memcpy(&tail, (const unsigned char *)src + body, count - body);
+
+		segs[nsegs].addr = addr + body;
+		segs[nsegs].data = &tail;
+		segs[nsegs].len = 4;
+		nsegs++;
 	}
 
-	dev->write(addr, src, count);
+	ZEP_SHIM_BUS_OP(dev, writev)(segs, nsegs);
 }
 
 static void *zep_shim_spinlock_alloc(void)
 {
 	struct k_sem *lock = NULL;
 
-	lock = k_malloc(sizeof(*lock));
+	lock = zep_shim_heap_alloc(sizeof(*lock));
 
 	if (!lock) {
 		LOG_ERR("%s: Unable to allocate memory for spinlock", __func__);
@@ -133,7 +556,7 @@ static void *zep_shim_spinlock_alloc(void)
 
 static void zep_shim_spinlock_free(void *lock)
 {
-	k_free(lock);
+	zep_shim_heap_free(lock);
 }
 
 static void zep_shim_spinlock_init(void *lock)
@@ -148,6 +571,8 @@ static void zep_shim_spinlock_take(void *lock)
 
 static void zep_shim_spinlock_rel(void *lock)
 {
+	zep_shim_pw_flush();
+
 	k_sem_give(lock);
 }
 
@@ -158,6 +583,8 @@ static void zep_shim_spinlock_irq_take(void *lock, unsigned long *flags)
 
 static void zep_shim_spinlock_irq_rel(void *lock, unsigned long *flags)
 {
+	zep_shim_pw_flush();
+
 	k_sem_give(lock);
 }
 
@@ -209,43 +636,258 @@ struct nwb {
 	void (*cleanup_cb)();
 	unsigned char priority;
 	bool chksum_done;
+	signed char pool;
+	struct net_buf *frag;
 };
 
 #ifndef CONFIG_NRF70_RADIO_TEST
-static void *zep_shim_nbuf_alloc(unsigned int size)
+/* The header and the data of a buffer share one allocation, the data
+ * follows the header at priv.
+ */
+#define ZEP_SHIM_NBUF_HEAP (-1)
+
+#ifdef CONFIG_NRF700X_NBUF_POOL
+#define ZEP_SHIM_NBUF_BLOCK(size) ROUND_UP(sizeof(struct nwb) + (size), 4)
+
+K_MEM_SLAB_DEFINE_STATIC(zep_shim_nbuf_small,
+			 ZEP_SHIM_NBUF_BLOCK(CONFIG_NRF700X_NBUF_POOL_SMALL_SIZE),
+			 CONFIG_NRF700X_NBUF_POOL_SMALL_COUNT, 4);
+K_MEM_SLAB_DEFINE_STATIC(zep_shim_nbuf_large,
+			 ZEP_SHIM_NBUF_BLOCK(CONFIG_NRF700X_NBUF_POOL_LARGE_SIZE),
+			 CONFIG_NRF700X_NBUF_POOL_LARGE_COUNT, 4);
+
+static struct k_mem_slab *const zep_shim_nbuf_pools[ZEP_SHIM_NBUF_POOLS] = {
+	&zep_shim_nbuf_small, &zep_shim_nbuf_large,
+};
+
+static struct zep_shim_nbuf_stats zep_shim_nbuf_stats = {
+	.pool = {
+		{ CONFIG_NRF700X_NBUF_POOL_SMALL_SIZE, CONFIG_NRF700X_NBUF_POOL_SMALL_COUNT },
+		{ CONFIG_NRF700X_NBUF_POOL_LARGE_SIZE, CONFIG_NRF700X_NBUF_POOL_LARGE_COUNT },
+	},
+};
+
+static struct k_spinlock zep_shim_nbuf_lock;
+
+/* Take the buffer from the smallest pool with a free block its data fits
+ * in, the heap only serves oversized buffers and exhausted pools.
+ */
+static struct nwb *zep_shim_nbuf_get(unsigned int size)
+{
+	uint32_t start = k_cycle_get_32();
+	struct zep_shim_nbuf_pool_stats *pool;
+	k_spinlock_key_t key;
+	void *block = NULL;
+	int i;
+
+	zep_shim_arena_check();
+
+	for (i = 0; i < ZEP_SHIM_NBUF_POOLS; i++) {
+		pool = &zep_shim_nbuf_stats.pool[i];
+
+		if (size > pool->size) {
+			continue;
+		}
+
+		if (!k_mem_slab_alloc(zep_shim_nbuf_pools[i], &block, K_NO_WAIT)) {
+			break;
+		}
+
+		key = k_spin_lock(&zep_shim_nbuf_lock);
+		pool->exhausted++;
+		k_spin_unlock(&zep_shim_nbuf_lock, key);
+	}
+
+	if (i == ZEP_SHIM_NBUF_POOLS) {
+		block = zep_shim_heap_alloc(sizeof(struct nwb) + size);
+		if (!block) {
+			return NULL;
+		}
+
+		i = ZEP_SHIM_NBUF_HEAP;
+	}
+
+	memset(block, 0, sizeof(struct nwb));
+	((struct nwb *)block)->priv = (struct nwb *)block + 1;
+	((struct nwb *)block)->pool = i;
+
+	key = k_spin_lock(&zep_shim_nbuf_lock);
+	if (i == ZEP_SHIM_NBUF_HEAP) {
+		zep_shim_nbuf_stats.heap++;
+	} else {
+		zep_shim_nbuf_stats.pool[i].allocs++;
+		zep_shim_nbuf_stats.pool[i].used++;
+	}
+	zep_shim_nbuf_stats.alloc_cycles += k_cycle_get_32() - start;
+	k_spin_unlock(&zep_shim_nbuf_lock, key);
+
+	return block;
+}
+
+static void zep_shim_nbuf_put(struct nwb *nwb)
+{
+	uint32_t start = k_cycle_get_32();
+	int pool = nwb->pool;
+	k_spinlock_key_t key;
+	bool live;
+
+	if (pool == ZEP_SHIM_NBUF_HEAP) {
+		zep_shim_heap_free(nwb);
+	} else {
+		live = zep_shim_arena_free_begin(&key);
+		if (live) {
+			k_mem_slab_free(zep_shim_nbuf_pools[pool], nwb);
+		}
+		zep_shim_arena_free_end(key);
+
+		if (!live) {
+			return;
+		}
+	}
+
+	key = k_spin_lock(&zep_shim_nbuf_lock);
+	if (pool != ZEP_SHIM_NBUF_HEAP) {
+		zep_shim_nbuf_stats.pool[pool].used--;
+	}
+	zep_shim_nbuf_stats.frees++;
+	zep_shim_nbuf_stats.free_cycles += k_cycle_get_32() - start;
+	k_spin_unlock(&zep_shim_nbuf_lock, key);
+}
+
+static inline void zep_shim_nbuf_pool_reset(void)
+{
+	k_spinlock_key_t key;
+	int i;
+
+	for (i = 0; i < ZEP_SHIM_NBUF_POOLS; i++) {
+		k_mem_slab_init(zep_shim_nbuf_pools[i], zep_shim_nbuf_pools[i]->buffer,
+				ZEP_SHIM_NBUF_BLOCK(zep_shim_nbuf_stats.pool[i].size),
+				zep_shim_nbuf_stats.pool[i].blocks);
+
+		key = k_spin_lock(&zep_shim_nbuf_lock);
+		zep_shim_nbuf_stats.pool[i].used = 0;
+		k_spin_unlock(&zep_shim_nbuf_lock, key);
+	}
+}
+
+void zep_shim_nbuf_stats_get(struct zep_shim_nbuf_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&zep_shim_nbuf_lock);
+
+	*stats = zep_shim_nbuf_stats;
+
+	k_spin_unlock(&zep_shim_nbuf_lock, key);
+}
+#else
+static struct nwb *zep_shim_nbuf_get(unsigned int size)
+{
+	struct nwb *nwb = zep_shim_heap_alloc(sizeof(struct nwb) + size);
+
+	if (nwb) {
+		memset(nwb, 0, sizeof(struct nwb));
+		nwb->priv = nwb + 1;
+		nwb->pool = ZEP_SHIM_NBUF_HEAP;
+	}
+
+	return nwb;
+}
+
+static void zep_shim_nbuf_put(struct nwb *nwb)
+{
+	zep_shim_heap_free(nwb);
+}
+
+static inline void zep_shim_nbuf_pool_reset(void)
+{
+}
+#endif /* CONFIG_NRF700X_NBUF_POOL */
+
+static struct nwb *zep_shim_nbuf_alloc_block(unsigned int size)
 {
 	struct nwb *nwb;
 
-	nwb = (struct nwb *)k_calloc(sizeof(struct nwb), sizeof(char));
+	nwb = zep_shim_nbuf_get(size);
 
 	if (!nwb)
 		return NULL;
 
-	nwb->priv = k_calloc(size, sizeof(char));
+	nwb->data = (unsigned char *)nwb->priv;
+	nwb->tail = nwb->data;
 
-	if (!nwb->priv) {
-		k_free(nwb);
+	return nwb;
+}
+
+#ifdef CONFIG_NRF700X_ZERO_COPY_RX
+#ifndef CONFIG_NET_BUF_VARIABLE_DATA_SIZE
+BUILD_ASSERT(CONFIG_NET_BUF_DATA_SIZE >= CONFIG_NRF700X_ZERO_COPY_RX_BUF_SIZE,
+	     "Zero copy RX needs network buffers holding a whole RX buffer");
+#endif /* CONFIG_NET_BUF_VARIABLE_DATA_SIZE */
+
+/* The data of the driver RX frame buffers is a network RX data fragment
+ * that net_pkt_from_nbuf() attaches to the packet as it is.
+ */
+static struct nwb *zep_shim_nbuf_alloc_frag(unsigned int size)
+{
+	struct net_buf *frag;
+	struct nwb *nwb;
+
+	frag = net_pkt_get_reserve_rx_data(size, K_NO_WAIT);
+
+	if (!frag) {
 		return NULL;
 	}
 
-	nwb->data = (unsigned char *)nwb->priv;
+	if (frag->frags || (net_buf_tailroom(frag) < size)) {
+		net_buf_unref(frag);
+		return NULL;
+	}
+
+	nwb = zep_shim_nbuf_get(0);
+
+	if (!nwb) {
+		net_buf_unref(frag);
+		return NULL;
+	}
+
+	nwb->frag = frag;
+	nwb->data = frag->data;
 	nwb->tail = nwb->data;
-	nwb->len = 0;
-	nwb->headroom = 0;
-	nwb->next = NULL;
 
 	return nwb;
 }
+#endif /* CONFIG_NRF700X_ZERO_COPY_RX */
 
-static void zep_shim_nbuf_free(void *nbuf)
+static void *zep_shim_nbuf_alloc(unsigned int size)
 {
+#ifdef CONFIG_NRF700X_ZERO_COPY_RX
 	struct nwb *nwb;
 
-	nwb = nbuf;
+	/* RX frame buffers are told from command and event buffers by
+	 * their size, only they go to the network RX data pool.
+	 */
+	if (size == CONFIG_NRF700X_ZERO_COPY_RX_BUF_SIZE) {
+		nwb = zep_shim_nbuf_alloc_frag(size);
 
-	k_free(((struct nwb *)nbuf)->priv);
+		if (nwb) {
+			return nwb;
+		}
+	}
+#endif /* CONFIG_NRF700X_ZERO_COPY_RX */
+
+	return zep_shim_nbuf_alloc_block(size);
+}
+
+static void zep_shim_nbuf_free(void *nbuf)
+{
+	struct nwb *nwb = nbuf;
+
+#ifdef CONFIG_NRF700X_ZERO_COPY_RX
+	if (nwb->frag) {
+		net_buf_unref(nwb->frag);
+	}
+#endif /* CONFIG_NRF700X_ZERO_COPY_RX */
 
-	k_free(nbuf);
+	zep_shim_nbuf_put(nwb);
 }
 
 static void zep_shim_nbuf_headroom_res(void *nbuf, unsigned int size)
@@ -329,6 +971,12 @@ static void zep_shim_nbuf_set_chksum_done(void *nbuf, unsigned char chksum_done)
 #include <zephyr/net/ethernet.h>
 #include <zephyr/net/net_core.h>
 
+#define ZEP_SHIM_TX_HEADROOM 100
+
+/* TX frames go to the driver as a copy in one buffer, with room in front
+ * for the driver headers. The bare-metal library has no data path, the
+ * network interface built on the shim calls this.
+ */
 void *net_pkt_to_nbuf(struct net_pkt *pkt)
 {
 	struct nwb *nwb;
@@ -337,13 +985,13 @@ void *net_pkt_to_nbuf(struct net_pkt *pkt)
 
 	len = net_pkt_get_len(pkt);
 
-	nwb = zep_shim_nbuf_alloc(len + 100);
+	nwb = zep_shim_nbuf_alloc_block(len + ZEP_SHIM_TX_HEADROOM);
 
 	if (!nwb) {
 		return NULL;
 	}
 
-	zep_shim_nbuf_headroom_res(nwb, 100);
+	zep_shim_nbuf_headroom_res(nwb, ZEP_SHIM_TX_HEADROOM);
 
 	data = zep_shim_nbuf_data_put(nwb, len);
 
@@ -355,22 +1003,79 @@ void *net_pkt_to_nbuf(struct net_pkt *pkt)
 	return nwb;
 }
 
+#ifdef CONFIG_NRF700X_ZERO_COPY_RX
+/* Never block the driver on the network packet pools, drop instead */
+#define ZEP_SHIM_RX_TIMEOUT K_NO_WAIT
+
+static struct zep_shim_rx_stats zep_shim_rx_stats;
+static struct k_spinlock zep_shim_rx_lock;
+
+/* Move the buffer data fragment to the packet, the data starts after the
+ * headroom reserved and pulled by the driver. The offset is taken from the
+ * start of the fragment storage, whatever headroom the pool reserved.
+ */
+static struct net_pkt *net_pkt_from_nbuf_frag(void *iface, struct nwb *nwb)
+{
+	struct net_buf *frag = nwb->frag;
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_rx_alloc_on_iface(iface, ZEP_SHIM_RX_TIMEOUT);
+
+	if (!pkt) {
+		return NULL;
+	}
+
+	nwb->frag = NULL;
+
+	net_buf_reset(frag);
+	net_buf_reserve(frag, nwb->data - frag->__buf);
+	net_buf_add(frag, nwb->len);
+
+	net_pkt_append_buffer(pkt, frag);
+
+	return pkt;
+}
+
+void zep_shim_rx_stats_get(struct zep_shim_rx_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&zep_shim_rx_lock);
+
+	*stats = zep_shim_rx_stats;
+
+	k_spin_unlock(&zep_shim_rx_lock, key);
+}
+#else
+#define ZEP_SHIM_RX_TIMEOUT K_MSEC(100)
+#endif /* CONFIG_NRF700X_ZERO_COPY_RX */
+
 void *net_pkt_from_nbuf(void *iface, void *frm)
 {
 	struct net_pkt *pkt = NULL;
 	unsigned char *data;
 	unsigned int len;
 	struct nwb *nwb = frm;
+#ifdef CONFIG_NRF700X_ZERO_COPY_RX
+	bool zero_copy = false;
+	k_spinlock_key_t key;
+#endif /* CONFIG_NRF700X_ZERO_COPY_RX */
 
 	if (!nwb) {
 		return NULL;
 	}
 
+#ifdef CONFIG_NRF700X_ZERO_COPY_RX
+	if (nwb->frag) {
+		zero_copy = true;
+		pkt = net_pkt_from_nbuf_frag(iface, nwb);
+		goto out;
+	}
+#endif /* CONFIG_NRF700X_ZERO_COPY_RX */
+
 	len = zep_shim_nbuf_data_size(nwb);
 
 	data = zep_shim_nbuf_data_get(nwb);
 
-	pkt = net_pkt_rx_alloc_with_buffer(iface, len, AF_UNSPEC, 0, K_MSEC(100));
+	pkt = net_pkt_rx_alloc_with_buffer(iface, len, AF_UNSPEC, 0, ZEP_SHIM_RX_TIMEOUT);
 
 	if (!pkt) {
 		goto out;
@@ -383,6 +1088,18 @@ void *net_pkt_from_nbuf(void *iface, void *frm)
 	}
 
 out:
+#ifdef CONFIG_NRF700X_ZERO_COPY_RX
+	key = k_spin_lock(&zep_shim_rx_lock);
+	if (!pkt) {
+		zep_shim_rx_stats.drops++;
+	} else if (zero_copy) {
+		zep_shim_rx_stats.zero_copy++;
+	} else {
+		zep_shim_rx_stats.copied++;
+	}
+	k_spin_unlock(&zep_shim_rx_lock, key);
+#endif /* CONFIG_NRF700X_ZERO_COPY_RX */
+
 	zep_shim_nbuf_free(nwb);
 	return pkt;
 }
@@ -409,7 +1126,7 @@ void *net_raw_pkt_from_nbuf(void *iface, void *frm,
 	nwb_data = zep_shim_nbuf_data_get(nwb);
 	total_len = raw_hdr_len + nwb_len;
 
-	data = (unsigned char *)k_malloc(total_len);
+	data = (unsigned char *)zep_shim_heap_alloc(total_len);
 	if (!data) {
 		LOG_ERR("%s: Unable to allocate memory for sniffer data packet", __func__);
 		goto out;
@@ -431,7 +1148,7 @@ void *net_raw_pkt_from_nbuf(void *iface, void *frm,
 	}
 out:
 	if (data != NULL) {
-		k_free(data);
+		zep_shim_heap_free(data);
 	}
 
 	if (pkt_free) {
@@ -441,13 +1158,17 @@ out:
 	return pkt;
 }
 #endif /* CONFIG_NRF700X_RAW_DATA_RX || CONFIG_NRF700X_PROMISC_DATA_RX */
+#else
+static inline void zep_shim_nbuf_pool_reset(void)
+{
+}
 #endif /* CONFIG_NRF70_RADIO_TEST */
 
 static void *zep_shim_llist_node_alloc(void)
 {
 	struct zep_shim_llist_node *llist_node = NULL;
 
-	llist_node = k_calloc(sizeof(*llist_node), sizeof(char));
+	llist_node = zep_shim_heap_zalloc(sizeof(*llist_node));
 
 	if (!llist_node) {
 		LOG_ERR("%s: Unable to allocate memory for linked list node", __func__);
@@ -461,7 +1182,7 @@ static void *zep_shim_llist_node_alloc(void)
 
 static void zep_shim_llist_node_free(void *llist_node)
 {
-	k_free(llist_node);
+	zep_shim_heap_free(llist_node);
 }
 
 static void *zep_shim_llist_node_data_get(void *llist_node)
@@ -486,7 +1207,7 @@ static void *zep_shim_llist_alloc(void)
 {
 	struct zep_shim_llist *llist = NULL;
 
-	llist = k_calloc(sizeof(*llist), sizeof(char));
+	llist = zep_shim_heap_zalloc(sizeof(*llist));
 
 	if (!llist) {
 		LOG_ERR("%s: Unable to allocate memory for linked list", __func__);
@@ -497,7 +1218,7 @@ static void *zep_shim_llist_alloc(void)
 
 static void zep_shim_llist_free(void *llist)
 {
-	k_free(llist);
+	zep_shim_heap_free(llist);
 }
 
 static void zep_shim_llist_init(void *llist)
@@ -667,6 +1388,18 @@ static void *zep_shim_bus_qspi_dev_add(void *os_qspi_priv, void *osal_qspi_dev_c
 		LOG_ERR("%s: RPU enable failed with error %d", __func__, ret);
 		return NULL;
 	}
+
+#ifdef CONFIG_NRF700X_BUS_CALIBRATE
+	/* Before the firmware is loaded, nothing else uses the bus */
+	ret = rpu_bus_calibrate();
+	if (ret) {
+		LOG_WRN("%s: Bus calibration failed, using defaults", __func__);
+	}
+#endif /* CONFIG_NRF700X_BUS_CALIBRATE */
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+	/* At the final bus clock and latency */
+	rpu_hl_burst_verify();
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
 	zep_qspi_priv->qspi_dev = dev;
 	zep_qspi_priv->dev_added = true;
 
@@ -680,6 +1413,8 @@ static void zep_shim_bus_qspi_dev_rem(void *priv)
 
 	ARG_UNUSED(dev);
 
+	zep_shim_pw_flush();
+
 	/* TODO: Make qspi_dev a dynamic instance and remove it here */
 	rpu_disable();
 }
@@ -688,7 +1423,7 @@ static void *zep_shim_bus_qspi_init(void)
 {
 	struct zep_shim_bus_qspi_priv *qspi_priv = NULL;
 
-	qspi_priv = k_calloc(sizeof(*qspi_priv), sizeof(char));
+	qspi_priv = zep_shim_heap_zalloc(sizeof(*qspi_priv));
 
 	if (!qspi_priv) {
 		LOG_ERR("%s: Unable to allocate memory for qspi_priv", __func__);
@@ -704,12 +1439,18 @@ static void zep_shim_bus_qspi_deinit(void *os_qspi_priv)
 
 	qspi_priv = os_qspi_priv;
 
-	k_free(qspi_priv);
+	zep_shim_heap_free(qspi_priv);
+
+#ifdef CONFIG_NRF700X_MEM_ARENA
+	zep_shim_mem_arena_release();
+#endif /* CONFIG_NRF700X_MEM_ARENA */
 }
 
 #ifdef CONFIG_NRF_WIFI_LOW_POWER
 static int zep_shim_bus_qspi_ps_sleep(void *os_qspi_priv)
 {
+	zep_shim_pw_flush();
+
 	rpu_sleep();
 
 	return 0;
@@ -717,6 +1458,8 @@ static int zep_shim_bus_qspi_ps_sleep(void *os_qspi_priv)
 
 static int zep_shim_bus_qspi_ps_wake(void *os_qspi_priv)
 {
+	zep_shim_pw_flush();
+
 	rpu_wakeup();
 
 	return 0;
@@ -745,6 +1488,9 @@ static void irq_work_handler(struct k_work *work)
 
 	ret = intr_priv->callbk_fn(intr_priv->callbk_data);
 
+	/* Push out the interrupt acknowledgment */
+	zep_shim_pw_flush();
+
 	if (ret) {
 		LOG_ERR("%s: Interrupt callback failed", __func__);
 	}
@@ -758,6 +1504,8 @@ static void zep_shim_irq_handler(const struct device *dev, struct gpio_callback
 	ARG_UNUSED(cb);
 	ARG_UNUSED(pins);
 
+	zep_shim_rc_invalidate_all();
+
 	k_work_schedule_for_queue(&zep_wifi_intr_q, &intr_priv->work, K_NO_WAIT);
 }
 
@@ -769,7 +1517,7 @@ static enum nrf_wifi_status zep_shim_bus_qspi_intr_reg(void *os_dev_ctx, void *c
 
 	ARG_UNUSED(os_dev_ctx);
 
-	intr_priv = k_calloc(sizeof(*intr_priv), sizeof(char));
+	intr_priv = zep_shim_heap_zalloc(sizeof(*intr_priv));
 
 	if (!intr_priv) {
 		LOG_ERR("%s: Unable to allocate memory for intr_priv", __func__);
@@ -785,11 +1533,13 @@ static enum nrf_wifi_status zep_shim_bus_qspi_intr_reg(void *os_dev_ctx, void *c
 
 	if (ret) {
 		LOG_ERR("%s: request_irq failed", __func__);
-		k_free(intr_priv);
+		zep_shim_heap_free(intr_priv);
 		intr_priv = NULL;
 		goto out;
 	}
 
+	zep_shim_rc_enable(true);
+
 	status = NRF_WIFI_STATUS_SUCCESS;
 
 out:
@@ -803,6 +1553,8 @@ static void zep_shim_bus_qspi_intr_unreg(void *os_qspi_dev_ctx)
 
 	ARG_UNUSED(os_qspi_dev_ctx);
 
+	zep_shim_rc_enable(false);
+
 	ret = rpu_irq_remove(&intr_priv->gpio_cb_data);
 	if (ret) {
 		LOG_ERR("%s: rpu_irq_remove failed", __func__);
@@ -811,16 +1563,89 @@ static void zep_shim_bus_qspi_intr_unreg(void *os_qspi_dev_ctx)
 
 	k_work_cancel_delayable_sync(&intr_priv->work, &sync);
 
-	k_free(intr_priv);
+	zep_shim_heap_free(intr_priv);
 	intr_priv = NULL;
 }
 
 #ifdef CONFIG_NRF_WIFI_LOW_POWER
+#ifdef CONFIG_NRF700X_MEM_ARENA
+/* Timers live in the arena, those the driver did not free are cancelled
+ * when it is released.
+ */
+struct zep_shim_timer {
+	struct timer_list timer;
+	sys_dnode_t node;
+};
+
+static sys_dlist_t zep_shim_timers = SYS_DLIST_STATIC_INIT(&zep_shim_timers);
+static struct k_spinlock zep_shim_timer_lock;
+
+static void *zep_shim_timer_alloc(void)
+{
+	struct zep_shim_timer *timer = NULL;
+	k_spinlock_key_t key;
+
+	timer = zep_shim_heap_alloc(sizeof(*timer));
+
+	if (!timer) {
+		LOG_ERR("%s: Unable to allocate memory for work", __func__);
+		return NULL;
+	}
+
+	key = k_spin_lock(&zep_shim_timer_lock);
+	sys_dlist_append(&zep_shim_timers, &timer->node);
+	k_spin_unlock(&zep_shim_timer_lock, key);
+
+	return &timer->timer;
+}
+
+static void zep_shim_timer_free(void *timer)
+{
+	struct zep_shim_timer *zep_timer = CONTAINER_OF(timer, struct zep_shim_timer, timer);
+	k_spinlock_key_t key;
+
+	/* Unless cancelled as leaked by the arena release */
+	key = k_spin_lock(&zep_shim_timer_lock);
+	if (sys_dnode_is_linked(&zep_timer->node)) {
+		sys_dlist_remove(&zep_timer->node);
+	}
+	k_spin_unlock(&zep_shim_timer_lock, key);
+
+	zep_shim_heap_free(zep_timer);
+}
+
+static void zep_shim_timer_cancel_all(void)
+{
+	struct zep_shim_timer *timer;
+	struct k_work_sync sync;
+	sys_dnode_t *node;
+	k_spinlock_key_t key;
+	int count = 0;
+
+	while (1) {
+		key = k_spin_lock(&zep_shim_timer_lock);
+		node = sys_dlist_get(&zep_shim_timers);
+		k_spin_unlock(&zep_shim_timer_lock, key);
+
+		if (!node) {
+			break;
+		}
+
+		timer = CONTAINER_OF(node, struct zep_shim_timer, node);
+		k_work_cancel_delayable_sync(&timer->timer.work, &sync);
+		count++;
+	}
+
+	if (count) {
+		LOG_WRN("%s: %d timers were not freed", __func__, count);
+	}
+}
+#else
 static void *zep_shim_timer_alloc(void)
 {
 	struct timer_list *timer = NULL;
 
-	timer = k_malloc(sizeof(*timer));
+	timer = zep_shim_heap_alloc(sizeof(*timer));
 
 	if (!timer)
 		LOG_ERR("%s: Unable to allocate memory for work", __func__);
@@ -828,6 +1653,12 @@ static void *zep_shim_timer_alloc(void)
 	return timer;
 }
 
+static void zep_shim_timer_free(void *timer)
+{
+	zep_shim_heap_free(timer);
+}
+#endif /* CONFIG_NRF700X_MEM_ARENA */
+
 static void zep_shim_timer_init(void *timer, void (*callback)(unsigned long), unsigned long data)
 {
 	((struct timer_list *)timer)->function = callback;
@@ -836,11 +1667,6 @@ static void zep_shim_timer_init(void *timer, void (*callback)(unsigned long), un
 	init_timer(timer);
 }
 
-static void zep_shim_timer_free(void *timer)
-{
-	k_free(timer);
-}
-
 static void zep_shim_timer_schedule(void *timer, unsigned long duration)
 {
 	mod_timer(timer, duration);
@@ -852,6 +1678,33 @@ static void zep_shim_timer_kill(void *timer)
 }
 #endif /* CONFIG_NRF_WIFI_LOW_POWER */
 
+#ifdef CONFIG_NRF700X_MEM_ARENA
+/* Re-initializes the released arena, called with the arena locked */
+static void zep_shim_mem_arena_reset(void)
+{
+	zep_shim_slab_reset();
+	zep_shim_nbuf_pool_reset();
+
+	k_heap_init(&zep_shim_arena, zep_shim_arena.heap.init_mem,
+		    zep_shim_arena.heap.init_bytes);
+}
+
+/* Releases everything the driver instance did not free */
+static void zep_shim_mem_arena_release(void)
+{
+	k_spinlock_key_t key;
+
+#ifdef CONFIG_NRF_WIFI_LOW_POWER
+	/* A pending timer would otherwise run from reused arena memory */
+	zep_shim_timer_cancel_all();
+#endif /* CONFIG_NRF_WIFI_LOW_POWER */
+
+	key = k_spin_lock(&zep_shim_arena_lock);
+	zep_shim_arena_released = true;
+	k_spin_unlock(&zep_shim_arena_lock, key);
+}
+#endif /* CONFIG_NRF700X_MEM_ARENA */
+
 static void zep_shim_assert(int test_val, int val, enum nrf_wifi_assert_op_type op, char *msg)
 {
 	switch (op) {
@@ -886,7 +1739,7 @@ static unsigned int zep_shim_strlen(const void *str)
 static const struct nrf_wifi_osal_ops nrf_wifi_os_zep_ops = {
 	.mem_alloc = zep_shim_mem_alloc,
 	.mem_zalloc = zep_shim_mem_zalloc,
-	.mem_free = k_free,
+	.mem_free = zep_shim_mem_free,
 	.mem_cpy = zep_shim_mem_cpy,
 	.mem_set = zep_shim_mem_set,
 	.mem_cmp = zep_shim_mem_cmp,
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the RPU memory accesses of the shell and the
+ * utilities, executed with the access type planned for each memory block.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "rpu_hw_if.h"
+#include "qspi_if.h"
+#ifdef CONFIG_NRF700X_READ_CACHE
+#include "shim.h"
+#endif /* CONFIG_NRF700X_READ_CACHE */
+#ifdef CONFIG_NRF700X_POSTED_WRITES
+#include "bus_cache.h"
+#endif /* CONFIG_NRF700X_POSTED_WRITES */
+
+LOG_MODULE_DECLARE(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
+
+static const struct qspi_dev *qdev;
+
+void rpu_access_init(const struct qspi_dev *dev)
+{
+	qdev = dev;
+}
+
+/* Transfers crossing memory blocks are split, each part is done with the
+ * access type of its block.
+ */
+int rpu_read(unsigned int addr, void *data, int len)
+{
+	struct rpu_access acc;
+	int ret;
+
+#ifdef CONFIG_NRF700X_POSTED_WRITES
+	/* Read what the OS layer wrote, including the writes still posted */
+	zep_shim_pw_flush();
+#endif /* CONFIG_NRF700X_POSTED_WRITES */
+
+	while (len > 0) {
+		if (rpu_plan(addr, len, &acc)) {
+			LOG_ERR("Address validation failed - pls check memmory map and re-try");
+			return -1;
+		}
+
+		if (acc.hl)
+			ret = qdev->hl_read(addr, data, acc.len, acc.latency);
+#ifdef CONFIG_NRF700X_QSPI_XIP
+		else if (acc.xip && qdev->xip_read)
+			ret = qdev->xip_read(addr, data, acc.len);
+#endif /* CONFIG_NRF700X_QSPI_XIP */
+		else
+			ret = qdev->read(addr, data, acc.len);
+
+		if (ret)
+			return ret;
+
+		addr += acc.len;
+		data = (uint8_t *)data + acc.len;
+		len -= acc.len;
+	}
+
+	return 0;
+}
+
+int rpu_write(unsigned int addr, const void *data, int len)
+{
+	struct rpu_access acc;
+	int ret;
+
+#ifdef CONFIG_NRF700X_POSTED_WRITES
+	/* A later flush of older posted writes would undo this write */
+	zep_shim_pw_flush();
+#endif /* CONFIG_NRF700X_POSTED_WRITES */
+
+	while (len > 0) {
+		if (rpu_plan(addr, len, &acc)) {
+			LOG_ERR("Address validation failed - pls check memmory map and re-try");
+			return -1;
+		}
+
+		if (!acc.writable) {
+			LOG_ERR("Error: Cannot write to ROM blocks");
+			return -1;
+		}
+
+		ret = qdev->write(addr, data, acc.len);
+
+#ifdef CONFIG_NRF700X_READ_CACHE
+		/* Keep the OS layer reads coherent with shell writes */
+		zep_shim_rc_invalidate(addr, acc.len);
+#endif /* CONFIG_NRF700X_READ_CACHE */
+
+		if (ret)
+			return ret;
+
+		addr += acc.len;
+		data = (const uint8_t *)data + acc.len;
+		len -= acc.len;
+	}
+
+	return 0;
+}
+
+int rpu_bus_begin(void)
+{
+	return qdev->bus_begin();
+}
+
+void rpu_bus_end(void)
+{
+	qdev->bus_end();
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the bus benchmark for the Zephyr OS layer of the
+ * Wi-Fi driver. Reads and writes are timed over the RPU RAM blocks for a
+ * range of transfer sizes and host buffer alignments.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif /* CONFIG_SHELL */
+
+#include "rpu_hw_if.h"
+#include "qspi_if.h"
+#ifdef CONFIG_NRF700X_BUS_STATIC_DISPATCH
+#include "bus_cache.h"
+#endif /* CONFIG_NRF700X_BUS_STATIC_DISPATCH */
+
+LOG_MODULE_DECLARE(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
+
+#define BENCH_ITERATIONS CONFIG_NRF700X_BUS_BENCH_ITERATIONS
+#define BENCH_MAX_SIZE CONFIG_NRF700X_BUS_BENCH_MAX_SIZE
+#define BENCH_MIN_SIZE 4
+#define BENCH_ALIGNS 4
+
+enum bench_path {
+	BENCH_PATH_RPU,
+	BENCH_PATH_BRACKET,
+	BENCH_PATH_DIRECT,
+#ifdef CONFIG_NRF700X_BUS_STATIC_DISPATCH
+	BENCH_PATH_STATIC,
+#endif /* CONFIG_NRF700X_BUS_STATIC_DISPATCH */
+	BENCH_PATH_HL,
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+	BENCH_PATH_HL_BURST,
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+	BENCH_PATH_NUM,
+};
+
+static const char * const bench_path_name[] = {
+	[BENCH_PATH_RPU] = "rpu",
+	[BENCH_PATH_BRACKET] = "bracket",
+	[BENCH_PATH_DIRECT] = "direct",
+#ifdef CONFIG_NRF700X_BUS_STATIC_DISPATCH
+	[BENCH_PATH_STATIC] = "static",
+#endif /* CONFIG_NRF700X_BUS_STATIC_DISPATCH */
+	[BENCH_PATH_HL] = "hl",
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+	[BENCH_PATH_HL_BURST] = "hl_burst",
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+};
+
+/* RAM blocks, free to overwrite until the firmware is loaded */
+static const int bench_blks[] = {
+	PKTRAM, GRAM, LMAC_RET_RAM, LMAC_SRC_RAM, UMAC_RET_RAM, UMAC_SRC_RAM
+};
+
+/* Extra bytes for the misaligned host buffer offsets */
+static uint32_t bench_buf[(BENCH_MAX_SIZE + BENCH_ALIGNS) / 4];
+static uint32_t bench_lat[BENCH_ITERATIONS];
+
+static void bench_sort(uint32_t *lat, int n)
+{
+	uint32_t v;
+	int i, j;
+
+	for (i = 1; i < n; i++) {
+		v = lat[i];
+
+		for (j = i; (j > 0) && (lat[j - 1] > v); j--) {
+			lat[j] = lat[j - 1];
+		}
+
+		lat[j] = v;
+	}
+}
+
+static int bench_xfer(struct qspi_dev *dev, bool write, enum bench_path path,
+		      unsigned int addr, void *data, int len, unsigned int latency)
+{
+	switch (path) {
+	case BENCH_PATH_RPU:
+	case BENCH_PATH_BRACKET:
+		return write ? rpu_write(addr, data, len) : rpu_read(addr, data, len);
+	case BENCH_PATH_DIRECT:
+		return write ? dev->write(addr, data, len) : dev->read(addr, data, len);
+#ifdef CONFIG_NRF700X_BUS_STATIC_DISPATCH
+	/* The same ops as direct, called as the OS layer calls them */
+	case BENCH_PATH_STATIC:
+		return write ? ZEP_SHIM_BUS_OP(dev, write)(addr, data, len) :
+			       ZEP_SHIM_BUS_OP(dev, read)(addr, data, len);
+#endif /* CONFIG_NRF700X_BUS_STATIC_DISPATCH */
+	default:
+		return dev->hl_read(addr, data, len, latency);
+	}
+}
+
+static int bench_run_one(struct qspi_dev *dev, bool write, enum bench_path path, int blk,
+			 uint32_t size, int align, struct rpu_bus_bench_result *res)
+{
+	unsigned int addr = rpu_7002_memmap[blk][0];
+	uint8_t *data = (uint8_t *)bench_buf + align;
+	struct rpu_access acc;
+	uint64_t total = 0;
+	uint32_t start;
+	int ret = 0;
+	int i;
+
+	ret = rpu_plan(addr, size, &acc);
+
+	if (ret) {
+		return ret;
+	}
+
+	/* All transfers of the point under one bus acquisition */
+	if (path == BENCH_PATH_BRACKET) {
+		ret = rpu_bus_begin();
+
+		if (ret) {
+			return ret;
+		}
+	}
+
+	for (i = 0; i < BENCH_ITERATIONS; i++) {
+		start = k_cycle_get_32();
+
+		ret = bench_xfer(dev, write, path, addr, data, size, acc.latency);
+
+		bench_lat[i] = k_cycle_get_32() - start;
+
+		if (ret) {
+			break;
+		}
+
+		total += bench_lat[i];
+	}
+
+	if (path == BENCH_PATH_BRACKET) {
+		rpu_bus_end();
+	}
+
+	if (ret) {
+		return ret;
+	}
+
+	bench_sort(bench_lat, BENCH_ITERATIONS);
+
+	res->write = write;
+	res->path = bench_path_name[path];
+	res->region = blk_name[blk];
+	res->size = size;
+	res->align = align;
+	res->bytes_per_sec = total ? (uint32_t)(((uint64_t)size * BENCH_ITERATIONS *
+						 sys_clock_hw_cycles_per_sec()) / total) : 0;
+	res->xfers_per_sec = total ? (uint32_t)(((uint64_t)BENCH_ITERATIONS *
+						 sys_clock_hw_cycles_per_sec()) / total) : 0;
+	res->p50_ns = k_cyc_to_ns_floor32(bench_lat[BENCH_ITERATIONS / 2]);
+	res->p99_ns = k_cyc_to_ns_floor32(bench_lat[(BENCH_ITERATIONS * 99) / 100]);
+
+	return 0;
+}
+
+int rpu_bus_bench_run(rpu_bus_bench_cb_t cb, void *ctx)
+{
+	struct qspi_dev *dev = qspi_dev();
+	struct rpu_bus_bench_result res;
+	enum bench_path path;
+	uint32_t size;
+	int write, align, i;
+	int ret;
+
+	for (i = 0; i < ARRAY_SIZE(bench_blks); i++) {
+		for (write = 1; write >= 0; write--) {
+			for (path = 0; path < BENCH_PATH_NUM; path++) {
+				if (write && (path >= BENCH_PATH_HL)) {
+					continue;
+				}
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+				/* Only the hl_burst path reads in bursts, the rpu and
+				 * hl paths read single words.
+				 */
+				dev->hl_burst_set(path == BENCH_PATH_HL_BURST);
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+
+				for (size = BENCH_MIN_SIZE; size <= BENCH_MAX_SIZE; size *= 4) {
+					for (align = 0; align < BENCH_ALIGNS; align++) {
+						ret = bench_run_one(dev, write, path, bench_blks[i],
+								    size, align, &res);
+						if (ret) {
+							LOG_ERR("Bus bench %s %s %s %d failed: %d",
+								write ? "write" : "read",
+								bench_path_name[path],
+								blk_name[bench_blks[i]], size, ret);
+							goto out;
+						}
+
+						cb(&res, ctx);
+					}
+				}
+			}
+		}
+	}
+
+	ret = 0;
+out:
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+	/* Back to the verified burst setting */
+	rpu_hl_burst_verify();
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+	return ret;
+}
+
+#ifdef CONFIG_SHELL
+static void bench_shell_print(const struct rpu_bus_bench_result *res, void *ctx)
+{
+	const struct shell *sh = ctx;
+
+	shell_print(sh, "%s,%s,%s,%u,%u,%u.%03u,%u,%u,%u",
+		    res->write ? "write" : "read", res->path, res->region, res->size,
+		    res->align, res->bytes_per_sec / 1000000, (res->bytes_per_sec / 1000) % 1000,
+		    res->p50_ns / 1000, res->p99_ns / 1000, res->xfers_per_sec);
+}
+
+static int cmd_bus_bench(const struct shell *sh, size_t argc, char **argv)
+{
+	shell_print(sh, "op,path,region,size,align,mb_per_s,p50_us,p99_us,xfers_per_s");
+
+	return rpu_bus_bench_run(bench_shell_print, (void *)sh);
+}
+
+SHELL_CMD_REGISTER(nrf70_bus_bench, NULL,
+		   "Benchmark the RPU bus, overwrites RPU RAM (run before the firmware is loaded)",
+		   cmd_bus_bench);
+#endif /* CONFIG_SHELL */
@@ -35,79 +35,9 @@ GPIO_DT_SPEC_GET(NRF7002_NODE, iovdd_ctrl_gpios);
 static const struct gpio_dt_spec bucken_spec =
 GPIO_DT_SPEC_GET(NRF7002_NODE, bucken_gpios);
 
-char blk_name[][15] = { "SysBus",   "ExtSysBus",	   "PBus",	   "PKTRAM",
-			       "GRAM",	   "LMAC_ROM",	   "LMAC_RET_RAM", "LMAC_SRC_RAM",
-			       "UMAC_ROM", "UMAC_RET_RAM", "UMAC_SRC_RAM" };
-
-uint32_t rpu_7002_memmap[][3] = {
-	{ 0x000000, 0x008FFF, 1 },
-	{ 0x009000, 0x03FFFF, 2 },
-	{ 0x040000, 0x07FFFF, 1 },
-	{ 0x0C0000, 0x0F0FFF, 0 },
-	{ 0x080000, 0x092000, 1 },
-	{ 0x100000, 0x134000, 1 },
-	{ 0x140000, 0x14C000, 1 },
-	{ 0x180000, 0x190000, 1 },
-	{ 0x200000, 0x261800, 1 },
-	{ 0x280000, 0x2A4000, 1 },
-	{ 0x300000, 0x338000, 1 }
-};
-
 static const struct qspi_dev *qdev;
 static struct qspi_config *cfg;
 
-static int validate_addr_blk(uint32_t start_addr,
-							 uint32_t end_addr,
-							 uint32_t block_no,
-							 bool *hl_flag,
-							 int *selected_blk)
-{
-	uint32_t *block_map = rpu_7002_memmap[block_no];
-
-	if (((start_addr >= block_map[0]) && (start_addr <= block_map[1])) &&
-	    ((end_addr >= block_map[0]) && (end_addr <= block_map[1]))) {
-		if (block_no == PKTRAM) {
-			*hl_flag = 0;
-		}
-		*selected_blk = block_no;
-		return 0;
-	}
-
-	return -1;
-}
-
-static int rpu_validate_addr(uint32_t start_addr, uint32_t len, bool *hl_flag)
-{
-	int ret = 0, i;
-	uint32_t end_addr;
-	int selected_blk;
-
-	end_addr = start_addr + len - 1;
-
-	*hl_flag = 1;
-
-	for (i = 0; i < NUM_MEM_BLOCKS; i++) {
-		ret = validate_addr_blk(start_addr, end_addr, i, hl_flag, &selected_blk);
-		if (!ret) {
-			break;
-		}
-	}
-
-	if (ret) {
-		LOG_ERR("Address validation failed - pls check memmory map and re-try");
-		return -1;
-	}
-
-	if ((selected_blk == LMAC_ROM) || (selected_blk == UMAC_ROM)) {
-		LOG_ERR("Error: Cannot write to ROM blocks");
-		return -1;
-	}
-
-	cfg->qspi_slave_latency = (*hl_flag) ? rpu_7002_memmap[selected_blk][2] : 0;
-
-	return 0;
-}
-
 int rpu_irq_config(struct gpio_callback *irq_callback_data, void (*irq_handler)())
 {
 	int ret;
@@ -274,63 +204,101 @@ static int rpu_pwroff(void)
 	return ret;
 }
 
-int rpu_read(unsigned int addr, void *data, int len)
+int rpu_sleep(void)
 {
-	bool hl_flag;
+#if CONFIG_NRF700X_ON_QSPI
+	return qspi_cmd_sleep_rpu(&qspi_perip);
+#else
+	return spim_cmd_sleep_rpu_fn();
+#endif
+}
 
-	if (rpu_validate_addr(addr, len, &hl_flag)) {
-		return -1;
+/* Updated by every caller of rpu_wakeup(), each counter on its own */
+static atomic_t rpu_wake_count;
+static atomic_t rpu_wake_fail;
+static atomic_t rpu_wake_max_us;
+static atomic_t rpu_wake_hist[RPU_WAKE_HIST_BUCKETS];
+
+static void rpu_wake_stats_update(uint32_t start_cyc, int ret)
+{
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start_cyc);
+	unsigned int bucket = 0;
+	atomic_val_t max;
+
+	if (ret) {
+		atomic_inc(&rpu_wake_fail);
+		return;
 	}
 
-	if (hl_flag)
-		return qdev->hl_read(addr, data, len);
-	else
-		return qdev->read(addr, data, len);
+	/* Bucket n counts wake ups that took [2^n, 2^(n+1)) us, the last one
+	 * everything longer.
+	 */
+	if (us) {
+		bucket = MIN(31 - __builtin_clz(us), RPU_WAKE_HIST_BUCKETS - 1);
+	}
+
+	atomic_inc(&rpu_wake_count);
+	atomic_inc(&rpu_wake_hist[bucket]);
+
+	do {
+		max = atomic_get(&rpu_wake_max_us);
+	} while ((us > (uint32_t)max) && !atomic_cas(&rpu_wake_max_us, max, us));
 }
 
-int rpu_write(unsigned int addr, const void *data, int len)
+void rpu_wake_stats_get(struct rpu_wake_stats *stats)
 {
-	bool hl_flag;
+	int i;
 
-	if (rpu_validate_addr(addr, len, &hl_flag)) {
-		return -1;
-	}
+	stats->count = atomic_get(&rpu_wake_count);
+	stats->fail = atomic_get(&rpu_wake_fail);
+	stats->max_us = atomic_get(&rpu_wake_max_us);
 
-	return qdev->write(addr, data, len);
+	for (i = 0; i < RPU_WAKE_HIST_BUCKETS; i++) {
+		stats->hist[i] = atomic_get(&rpu_wake_hist[i]);
+	}
 }
 
-int rpu_sleep(void)
+void rpu_wake_stats_reset(void)
 {
-#if CONFIG_NRF700X_ON_QSPI
-	return qspi_cmd_sleep_rpu(&qspi_perip);
-#else
-	return spim_cmd_sleep_rpu_fn();
-#endif
+	int i;
+
+	atomic_clear(&rpu_wake_count);
+	atomic_clear(&rpu_wake_fail);
+	atomic_clear(&rpu_wake_max_us);
+
+	for (i = 0; i < RPU_WAKE_HIST_BUCKETS; i++) {
+		atomic_clear(&rpu_wake_hist[i]);
+	}
 }
 
 int rpu_wakeup(void)
 {
+	uint32_t start_cyc = k_cycle_get_32();
 	int ret;
 
 	ret = rpu_wrsr2(1);
 	if (ret) {
 		LOG_ERR("Error: WRSR2 failed");
-		return ret;
+		goto out;
 	}
 
 	ret = rpu_rdsr2();
 	if (ret < 0) {
 		LOG_ERR("Error: RDSR2 failed");
-		return ret;
+		goto out;
 	}
 
 	ret = rpu_rdsr1();
 	if (ret < 0) {
 		LOG_ERR("Error: RDSR1 failed");
-		return ret;
+		goto out;
 	}
 
-	return 0;
+	ret = 0;
+out:
+	rpu_wake_stats_update(start_cyc, ret);
+
+	return ret;
 }
 
 int rpu_sleep_status(void)
@@ -403,6 +371,235 @@ int rpu_clks_on(void)
 	return 0;
 }
 
+#if defined(CONFIG_NRF700X_BUS_CALIBRATE) || defined(CONFIG_NRF700X_HL_READ_BURST)
+/* Scratch areas for the calibration. Their contents are saved and restored
+ * around the test patterns, as the burst verification also runs from the
+ * bench with the firmware loaded.
+ */
+#define RPU_CAL_PKTRAM_ADDR 0x0C0000
+#define RPU_CAL_GRAM_ADDR 0x080000
+#define RPU_CAL_WORDS 16
+#define RPU_CAL_PATTERNS 4
+
+static uint32_t rpu_cal_word(int pattern, int i)
+{
+	switch (pattern) {
+	case 0:
+		return (i & 1) ? 0x55555555 : 0xAAAAAAAA;
+	case 1:
+		return (i & 1) ? 0xFFFFFFFF : 0x00000000;
+	case 2:
+		return BIT(i % 32);
+	default:
+		return ~BIT(i % 32);
+	}
+}
+
+/* Read the scratch words at the current, trusted, bus settings */
+static int rpu_cal_save(uint32_t addr, bool hl, uint32_t *buf)
+{
+	if (hl) {
+		return qdev->hl_read(addr, buf, RPU_CAL_WORDS * 4, cfg->qspi_slave_latency);
+	}
+
+	return qdev->read(addr, buf, RPU_CAL_WORDS * 4);
+}
+
+static void rpu_cal_restore(uint32_t addr, const uint32_t *buf)
+{
+	if (qdev->write(addr, buf, RPU_CAL_WORDS * 4)) {
+		LOG_ERR("%s: Failed to restore RPU memory at 0x%x", __func__, addr);
+	}
+}
+
+/* Write and read back the test patterns, through high-latency reads with
+ * the given slave latency if hl is set.
+ */
+static int rpu_cal_check(uint32_t addr, bool hl, unsigned int latency)
+{
+	uint32_t wr[RPU_CAL_WORDS];
+	uint32_t rd[RPU_CAL_WORDS];
+	int pattern, i, ret;
+
+	for (pattern = 0; pattern < RPU_CAL_PATTERNS; pattern++) {
+		for (i = 0; i < RPU_CAL_WORDS; i++) {
+			wr[i] = rpu_cal_word(pattern, i);
+		}
+
+		memset(rd, 0, sizeof(rd));
+
+		ret = qdev->write(addr, wr, sizeof(wr));
+		if (ret) {
+			return ret;
+		}
+
+		if (hl) {
+			ret = qdev->hl_read(addr, rd, sizeof(rd), latency);
+		} else {
+			ret = qdev->read(addr, rd, sizeof(rd));
+		}
+
+		if (ret || memcmp(wr, rd, sizeof(wr))) {
+			return -EIO;
+		}
+	}
+
+	return 0;
+}
+#endif /* CONFIG_NRF700X_BUS_CALIBRATE || CONFIG_NRF700X_HL_READ_BURST */
+
+#ifdef CONFIG_NRF700X_HL_READ_BURST
+int rpu_hl_burst_verify(void)
+{
+	uint32_t save[RPU_CAL_WORDS];
+	int ret;
+
+	/* Single word reads until the bursts are verified */
+	qdev->hl_burst_set(false);
+
+	ret = rpu_cal_save(RPU_CAL_GRAM_ADDR, true, save);
+	if (ret) {
+		LOG_WRN("Burst high-latency reads not verified, reading single words");
+		return ret;
+	}
+
+	qdev->hl_burst_set(true);
+
+	/* The patterns are read back as one burst of RPU_CAL_WORDS words */
+	ret = rpu_cal_check(RPU_CAL_GRAM_ADDR, true, cfg->qspi_slave_latency);
+
+	rpu_cal_restore(RPU_CAL_GRAM_ADDR, save);
+
+	if (ret) {
+		qdev->hl_burst_set(false);
+		LOG_WRN("Burst high-latency reads failed verification, reading single words");
+	}
+
+	return ret;
+}
+#endif /* CONFIG_NRF700X_HL_READ_BURST */
+
+#ifdef CONFIG_NRF700X_BUS_CALIBRATE
+static const uint32_t rpu_cal_freqs[] = { MHZ(8), MHZ(16), MHZ(24), MHZ(32), MHZ(48) };
+
+/* Largest slave latency (in words) the high-latency reads support */
+#define RPU_CAL_MAX_LATENCY 2
+
+static struct rpu_bus_cal rpu_bus_cal;
+
+/* Smallest slave latency that reads the patterns back from GRAM */
+static int rpu_cal_latency(void)
+{
+	unsigned int latency;
+
+	for (latency = 0; latency <= RPU_CAL_MAX_LATENCY; latency++) {
+		if (!rpu_cal_check(RPU_CAL_GRAM_ADDR, true, latency)) {
+			return latency;
+		}
+	}
+
+	return -EIO;
+}
+
+int rpu_bus_calibrate(void)
+{
+	uint32_t orig_freq = qdev->get_freq();
+	uint32_t save_pktram[RPU_CAL_WORDS];
+	uint32_t save_gram[RPU_CAL_WORDS];
+	unsigned int latency = 0;
+	uint32_t best_freq = 0;
+	uint32_t freq;
+	int i, ret;
+
+	ret = rpu_cal_save(RPU_CAL_PKTRAM_ADDR, false, save_pktram);
+	if (!ret) {
+		ret = rpu_cal_save(RPU_CAL_GRAM_ADDR, true, save_gram);
+	}
+
+	if (ret) {
+		LOG_ERR("Bus calibration failed to save RPU memory");
+		return ret;
+	}
+
+	/* Increase the frequency until the patterns no longer read back,
+	 * directly or with high-latency reads at any supported latency.
+	 */
+	for (i = 0; i < ARRAY_SIZE(rpu_cal_freqs); i++) {
+		if (rpu_cal_freqs[i] > CONFIG_NRF700X_BUS_CALIBRATE_MAX_FREQ) {
+			break;
+		}
+
+		if (qdev->set_freq(rpu_cal_freqs[i])) {
+			break;
+		}
+
+		/* Steps rounded to an already tested divider */
+		freq = qdev->get_freq();
+
+		if (freq <= best_freq) {
+			continue;
+		}
+
+		if (rpu_cal_check(RPU_CAL_PKTRAM_ADDR, false, 0)) {
+			break;
+		}
+
+		ret = rpu_cal_latency();
+		if (ret < 0) {
+			break;
+		}
+
+		best_freq = freq;
+		latency = ret;
+	}
+
+	if (!best_freq) {
+		LOG_ERR("Bus calibration failed, keeping %d Hz", orig_freq);
+		qdev->set_freq(orig_freq);
+		ret = -EIO;
+		goto out;
+	}
+
+	/* The bus picks a default latency for the clock, use the measured
+	 * one instead.
+	 */
+	qdev->set_freq(best_freq);
+	cfg->qspi_slave_latency = latency;
+
+	rpu_bus_cal.freq = best_freq;
+	rpu_bus_cal.latency = latency;
+	rpu_bus_cal.valid = true;
+
+	LOG_INF("Bus calibrated: freq = %d Hz, latency = %d", best_freq, latency);
+
+	ret = 0;
+out:
+	rpu_cal_restore(RPU_CAL_PKTRAM_ADDR, save_pktram);
+	rpu_cal_restore(RPU_CAL_GRAM_ADDR, save_gram);
+
+	return ret;
+}
+
+int rpu_bus_cal_get(struct rpu_bus_cal *cal)
+{
+	if (!rpu_bus_cal.valid) {
+		return -ENODATA;
+	}
+
+	*cal = rpu_bus_cal;
+
+	return 0;
+}
+#endif /* CONFIG_NRF700X_BUS_CALIBRATE */
+
+uint32_t rpu_bus_bandwidth_get(void)
+{
+	/* Quad QSPI moves 4 bits per clock, SPIM one */
+	uint32_t lines = (IS_ENABLED(CONFIG_NRF700X_ON_QSPI) && cfg->quad_spi) ? 4 : 1;
+
+	return qdev->get_freq() * lines;
+}
+
 #define CALL_RPU_FUNC(func, ...) \
 	do { \
 		ret = func(__VA_ARGS__); \
@@ -418,6 +615,7 @@ int rpu_init(void)
 
 	qdev = qspi_dev();
 	cfg = qspi_get_config();
+	rpu_access_init(qdev);
 
 	CALL_RPU_FUNC(rpu_gpio_config);
 
@@ -474,6 +672,7 @@ int rpu_disable(void)
 #ifdef CONFIG_NRF700X_SR_COEX_RF_SWITCH
 	CALL_RPU_FUNC(sr_gpio_remove);
 #endif
+	rpu_access_init(NULL);
 	qdev = NULL;
 	cfg = NULL;
 
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @brief File containing the RPU memory map and the planning of accesses
+ * to RPU memory for the Zephyr OS layer of the Wi-Fi driver.
+ */
+
+#include <zephyr/kernel.h>
+
+#include "rpu_hw_if.h"
+#include "qspi_if.h"
+
+char blk_name[][15] = { "SysBus",   "ExtSysBus",	   "PBus",	   "PKTRAM",
+			       "GRAM",	   "LMAC_ROM",	   "LMAC_RET_RAM", "LMAC_SRC_RAM",
+			       "UMAC_ROM", "UMAC_RET_RAM", "UMAC_SRC_RAM" };
+
+/* Block, start and end (inclusive) of each RPU memory block */
+#define RPU_MEMMAP(BLK)                                                                            \
+	BLK(SYSBUS, 0x000000, 0x008FFF)                                                            \
+	BLK(EXT_SYS_BUS, 0x009000, 0x03FFFF)                                                       \
+	BLK(PBUS, 0x040000, 0x07FFFF)                                                              \
+	BLK(PKTRAM, 0x0C0000, 0x0F0FFF)                                                            \
+	BLK(GRAM, 0x080000, 0x092000)                                                              \
+	BLK(LMAC_ROM, 0x100000, 0x134000)                                                          \
+	BLK(LMAC_RET_RAM, 0x140000, 0x14C000)                                                      \
+	BLK(LMAC_SRC_RAM, 0x180000, 0x190000)                                                      \
+	BLK(UMAC_ROM, 0x200000, 0x261800)                                                          \
+	BLK(UMAC_RET_RAM, 0x280000, 0x2A4000)                                                      \
+	BLK(UMAC_SRC_RAM, 0x300000, 0x338000)
+
+#define RPU_MEMMAP_ENTRY(blk, start, end) [blk] = { start, end },
+
+const uint32_t rpu_7002_memmap[][2] = {
+	RPU_MEMMAP(RPU_MEMMAP_ENTRY)
+};
+
+/* The OS layer and the shell read the register spaces and GRAM, everything
+ * below PKTRAM, with high-latency reads.
+ */
+#define RPU_HL_ADDR_END 0x0C0000
+
+/* Block of each 4 KB page of the RPU address space plus one, 0 if unmapped.
+ * All blocks start on a page boundary and no two share a page, the table
+ * is built at compile time.
+ */
+#define RPU_PAGE_SHIFT 12
+#define RPU_NUM_PAGES ((0x338000 >> RPU_PAGE_SHIFT) + 1)
+
+#define RPU_PAGE_ENTRY(blk, start, end)                                                            \
+	[(start) >> RPU_PAGE_SHIFT ... (end) >> RPU_PAGE_SHIFT] = (blk) + 1,
+
+static const uint8_t rpu_page_blk[RPU_NUM_PAGES] = {
+	RPU_MEMMAP(RPU_PAGE_ENTRY)
+};
+
+int rpu_plan(uint32_t addr, uint32_t len, struct rpu_access *acc)
+{
+	uint32_t page = addr >> RPU_PAGE_SHIFT;
+	int blk;
+
+	if (!len || (page >= RPU_NUM_PAGES) || !rpu_page_blk[page]) {
+		return -EINVAL;
+	}
+
+	blk = rpu_page_blk[page] - 1;
+
+	if ((addr < rpu_7002_memmap[blk][0]) || (addr > rpu_7002_memmap[blk][1])) {
+		return -EINVAL;
+	}
+
+	acc->blk = blk;
+	acc->len = MIN(len, rpu_7002_memmap[blk][1] - addr + 1);
+	acc->hl = addr < RPU_HL_ADDR_END;
+	/* Set by the bus for its current clock */
+	acc->latency = acc->hl ? qspi_get_config()->qspi_slave_latency : 0;
+	acc->writable = (blk != LMAC_ROM) && (blk != UMAC_ROM);
+#ifdef CONFIG_NRF700X_READ_CACHE
+	acc->cacheable = (CONFIG_NRF700X_READ_CACHE_REGIONS & BIT(blk)) != 0;
+#else
+	acc->cacheable = false;
+#endif /* CONFIG_NRF700X_READ_CACHE */
+	/* Mapped reads cannot insert slave latency dummy words. PKTRAM is
+	 * the only block read without latency at every clock.
+	 */
+	acc->xip = IS_ENABLED(CONFIG_NRF700X_QSPI_XIP) && (blk == PKTRAM);
+
+	return 0;
+}
+
+#ifdef CONFIG_NRF700X_READ_CACHE
+bool rpu_addr_cacheable(uint32_t addr, uint32_t len)
+{
+	struct rpu_access acc;
+
+	return !rpu_plan(addr, len, &acc) && (acc.len == len) && acc.cacheable;
+}
+#endif /* CONFIG_NRF700X_READ_CACHE */
+
+#ifdef CONFIG_NRF700X_QSPI_XIP
+bool rpu_addr_xip_capable(uint32_t addr, uint32_t len)
+{
+	struct rpu_access acc;
+
+	return !rpu_plan(addr, len, &acc) && (acc.len == len) && acc.xip;
+}
+#endif /* CONFIG_NRF700X_QSPI_XIP */
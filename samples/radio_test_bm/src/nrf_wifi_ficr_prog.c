@@ -159,10 +159,23 @@ static unsigned int read_otp_location(unsigned int offset, unsigned int *read_va
 
 static int  write_otp_location(unsigned int otp_location_offset, unsigned int otp_data)
 {
+	int err;
+
+	/* One bus acquisition per location, released between locations */
+	err = rpu_bus_begin();
+	if (err) {
+		LOG_ERR("Bus not available for OTP write: %d", err);
+		return -ENOEXEC;
+	}
+
 	write_word(OTP_WRENABLE_ADDR,  otp_location_offset);
 	write_word(OTP_WRITEREG_ADDR,  otp_data);
 
-	return poll_otp_wrdone();
+	err = poll_otp_wrdone();
+
+	rpu_bus_end();
+
+	return err;
 }
 
 
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Bus benchmark against the simulated nRF70.
+ *
+ * Runs rpu_bus_bench_run() over the SPIM backend and the simulated device
+ * and prints the same CSV as the nrf70_bus_bench shell command, so that
+ * regressions of the shim bus layer show up without hardware. The
+ * simulated device takes the wire time of each transfer at the SPI clock
+ * plus a fixed per transaction overhead.
+ */
+
+#include <string.h>
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+
+#include "rpu_hw_if.h"
+#include "qspi_if.h"
+#include "nrf70_spi_emul.h"
+
+LOG_MODULE_REGISTER(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
+
+/* spi-max-frequency of the simulated device */
+#define SPI_FREQ MHZ(8)
+#define PKTRAM_ADDR 0x0C0000
+#define GRAM_ADDR 0x080000
+
+/**
+ * struct bench_summary - Points of the run checked against the model.
+ * @rows: Number of points reported.
+ * @direct: Throughput of the largest direct PKTRAM read.
+ * @hl: Throughput of the largest single word GRAM read.
+ * @static_rows: Number of points calling the backend directly.
+ */
+struct bench_summary {
+	int rows;
+	uint32_t direct;
+	uint32_t hl;
+	int static_rows;
+};
+
+static bool bench_is(const struct rpu_bus_bench_result *res, const char *path,
+		     const char *region)
+{
+	return !res->write && !res->align && (res->size == CONFIG_NRF700X_BUS_BENCH_MAX_SIZE) &&
+	       !strcmp(res->path, path) && !strcmp(res->region, region);
+}
+
+static void bench_report(const struct rpu_bus_bench_result *res, void *ctx)
+{
+	struct bench_summary *sum = ctx;
+
+	printk("%s,%s,%s,%u,%u,%u.%03u,%u,%u,%u\n",
+	       res->write ? "write" : "read", res->path, res->region, res->size,
+	       res->align, res->bytes_per_sec / 1000000, (res->bytes_per_sec / 1000) % 1000,
+	       res->p50_ns / 1000, res->p99_ns / 1000, res->xfers_per_sec);
+
+	zassert_true(res->p50_ns <= res->p99_ns);
+	/* Nothing moves data faster than the wire */
+	zassert_true(res->bytes_per_sec < SPI_FREQ / 8, "%s %s %u", res->path, res->region,
+		     res->size);
+
+	if (bench_is(res, "direct", "PKTRAM")) {
+		sum->direct = res->bytes_per_sec;
+	} else if (bench_is(res, "hl", "GRAM")) {
+		sum->hl = res->bytes_per_sec;
+	}
+
+	if (!strcmp(res->path, "static")) {
+		sum->static_rows++;
+	}
+
+	sum->rows++;
+}
+
+static void *bus_bench_setup(void)
+{
+	struct qspi_dev *dev = qspi_dev();
+
+	zassert_ok(dev->init(qspi_defconfig()));
+	rpu_access_init(dev);
+
+	return NULL;
+}
+
+ZTEST(bus_bench, test_rpu_roundtrip)
+{
+	struct nrf70_emul_stats stats;
+	uint32_t wr[16], rd[16];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(wr); i++) {
+		wr[i] = 0xA5000000 | i;
+	}
+
+	zassert_ok(rpu_write(PKTRAM_ADDR, wr, sizeof(wr)));
+	zassert_mem_equal(nrf70_emul_mem(PKTRAM_ADDR), wr, sizeof(wr));
+
+	nrf70_emul_stats_reset();
+
+	memset(rd, 0, sizeof(rd));
+	zassert_ok(rpu_read(PKTRAM_ADDR, rd, sizeof(rd)));
+	zassert_mem_equal(rd, wr, sizeof(wr));
+
+	/* PKTRAM is read in one transaction */
+	nrf70_emul_stats_get(&stats);
+	zassert_equal(stats.xfers, 1);
+
+	/* GRAM through high-latency reads */
+	nrf70_emul_mem_fill(GRAM_ADDR, sizeof(rd));
+	zassert_ok(rpu_read(GRAM_ADDR, rd, sizeof(rd)));
+
+	for (i = 0; i < ARRAY_SIZE(rd); i++) {
+		zassert_equal(rd[i], GRAM_ADDR + i * 4);
+	}
+}
+
+ZTEST(bus_bench, test_bench)
+{
+	struct bench_summary sum = { 0 };
+
+	printk("op,path,region,size,align,mb_per_s,p50_us,p99_us,xfers_per_s\n");
+
+	zassert_ok(rpu_bus_bench_run(bench_report, &sum));
+
+	zassert_true(sum.rows > 0);
+	/* Every direct point is also measured through static dispatch */
+	zassert_true(sum.static_rows > 0);
+
+	/* A large direct read is close to the wire speed, single word
+	 * high-latency reads pay a header and the overhead per word.
+	 */
+	zassert_true(sum.direct > (SPI_FREQ / 8) * 9 / 10, "direct %u", sum.direct);
+	zassert_true(sum.hl < sum.direct / 2, "hl %u", sum.hl);
+}
+
+ZTEST_SUITE(bus_bench, NULL, bus_bench_setup, NULL, NULL, NULL);
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Tests of the posted writes and the read cache of RPU memory
+ * accesses.
+ */
+
+#include <string.h>
+
+#include <zephyr/ztest.h>
+
+#include "shim.h"
+#include "bus_cache.h"
+
+#define PKTRAM_ADDR 0x0C0000
+#define GRAM_ADDR 0x080000
+#define LINE_SIZE 32
+#define MAX_XFERS 16
+
+/**
+ * struct bus_xfer - Bus access seen by the mock bus device.
+ * @write: Access is a write.
+ * @hl: Access is a high-latency read.
+ * @addr: RPU address.
+ * @len: Length in bytes.
+ * @data: First words written.
+ */
+struct bus_xfer {
+	bool write;
+	bool hl;
+	unsigned int addr;
+	int len;
+	uint32_t data[4];
+};
+
+/* Bus configuration, as device.c provides it */
+static struct qspi_config test_cfg = {
+	.qspi_slave_latency = 1,
+};
+
+static struct bus_xfer xfers[MAX_XFERS];
+static int num_xfers;
+static int write_ret;
+
+static struct bus_xfer *mock_record(bool write, bool hl, unsigned int addr, int len)
+{
+	struct bus_xfer *xfer;
+
+	zassert_true(num_xfers < MAX_XFERS);
+
+	xfer = &xfers[num_xfers++];
+
+	xfer->write = write;
+	xfer->hl = hl;
+	xfer->addr = addr;
+	xfer->len = len;
+
+	return xfer;
+}
+
+/* RPU memory reads back the address of each word */
+static void mock_fill(unsigned int addr, void *data, int len)
+{
+	uint32_t *words = data;
+	int i;
+
+	for (i = 0; i < len / 4; i++) {
+		words[i] = addr + i * 4;
+	}
+}
+
+static int mock_read(unsigned int addr, void *data, int len)
+{
+	mock_record(false, false, addr, len);
+	mock_fill(addr, data, len);
+
+	return 0;
+}
+
+static int mock_hl_read(unsigned int addr, void *data, int len, unsigned int latency)
+{
+	mock_record(false, true, addr, len);
+	mock_fill(addr, data, len);
+
+	return 0;
+}
+
+static int mock_write(unsigned int addr, const void *data, int len)
+{
+	struct bus_xfer *xfer = mock_record(true, false, addr, len);
+
+	memcpy(xfer->data, data, MIN(len, sizeof(xfer->data)));
+
+	return write_ret;
+}
+
+static struct qspi_dev mock_dev = {
+	.read = mock_read,
+	.write = mock_write,
+	.hl_read = mock_hl_read,
+};
+
+struct qspi_config *qspi_get_config(void)
+{
+	return &test_cfg;
+}
+
+static void assert_write(int i, unsigned int addr, int len)
+{
+	zassert_true(i < num_xfers, "write %d missing", i);
+	zassert_true(xfers[i].write, "xfer %d", i);
+	zassert_equal(xfers[i].addr, addr, "xfer %d", i);
+	zassert_equal(xfers[i].len, len, "xfer %d", i);
+}
+
+static void post_word(unsigned long addr, uint32_t val)
+{
+	zep_shim_pw_post(&mock_dev, addr, &val, 1);
+}
+
+static uint32_t rc_read_word(unsigned long addr)
+{
+	uint32_t val = 0;
+
+	zassert_true(zep_shim_rc_read(&mock_dev, addr, &val, 4));
+
+	return val;
+}
+
+static void bus_cache_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zep_shim_pw_flush();
+	zep_shim_rc_enable(true);
+	num_xfers = 0;
+	write_ret = 0;
+}
+
+ZTEST(bus_cache, test_pw_combines_consecutive)
+{
+	struct zep_shim_pw_stats before, after;
+
+	zep_shim_pw_stats_get(&before);
+
+	post_word(0x1000, 0x11);
+	post_word(0x1004, 0x22);
+	post_word(0x1008, 0x33);
+
+	zassert_equal(num_xfers, 0);
+
+	zep_shim_pw_flush();
+
+	zassert_equal(num_xfers, 1);
+	assert_write(0, 0x1000, 12);
+	zassert_equal(xfers[0].data[0], 0x11);
+	zassert_equal(xfers[0].data[1], 0x22);
+	zassert_equal(xfers[0].data[2], 0x33);
+
+	zep_shim_pw_stats_get(&after);
+	zassert_equal(after.posted - before.posted, 3);
+	zassert_equal(after.combined - before.combined, 2);
+	zassert_equal(after.flushes - before.flushes, 1);
+}
+
+ZTEST(bus_cache, test_pw_keeps_order)
+{
+	post_word(0x1004, 0x11);
+	post_word(0x1000, 0x22);
+
+	/* A write not extending the run is only posted after the run */
+	zassert_equal(num_xfers, 1);
+	assert_write(0, 0x1004, 4);
+
+	post_word(0x1004, 0x33);
+	zep_shim_pw_flush();
+
+	zassert_equal(num_xfers, 2);
+	assert_write(1, 0x1000, 8);
+	zassert_equal(xfers[1].data[0], 0x22);
+	zassert_equal(xfers[1].data[1], 0x33);
+}
+
+ZTEST(bus_cache, test_pw_flushes_when_full)
+{
+	uint32_t vals[4] = { 1, 2, 3, 4 };
+
+	zep_shim_pw_post(&mock_dev, 0x1000, vals, 3);
+	post_word(0x100C, 5);
+	zassert_equal(num_xfers, 0);
+
+	/* Consecutive, but the buffer holds 4 words */
+	post_word(0x1010, 6);
+	zassert_equal(num_xfers, 1);
+	assert_write(0, 0x1000, 16);
+	zassert_equal(xfers[0].data[3], 5);
+
+	zep_shim_pw_flush();
+	assert_write(1, 0x1010, 4);
+	zassert_equal(xfers[1].data[0], 6);
+}
+
+ZTEST(bus_cache, test_pw_flushes_on_timeout)
+{
+	post_word(0x1000, 0x11);
+
+	k_sleep(K_MSEC(2));
+
+	zassert_equal(num_xfers, 1);
+	assert_write(0, 0x1000, 4);
+
+	zep_shim_pw_flush();
+	zassert_equal(num_xfers, 1);
+}
+
+ZTEST(bus_cache, test_pw_counts_errors)
+{
+	struct zep_shim_pw_stats before, after;
+
+	zep_shim_pw_stats_get(&before);
+
+	post_word(0x1000, 0x11);
+	write_ret = -EIO;
+	zep_shim_pw_flush();
+
+	/* Dropped, not retried on the next flush */
+	write_ret = 0;
+	zep_shim_pw_flush();
+	zassert_equal(num_xfers, 1);
+
+	zep_shim_pw_stats_get(&after);
+	zassert_equal(after.errors - before.errors, 1);
+	zassert_equal(after.flushes - before.flushes, 1);
+}
+
+ZTEST(bus_cache, test_rc_hit)
+{
+	struct zep_shim_rc_stats before, after;
+
+	zep_shim_rc_stats_get(&before);
+
+	zassert_equal(rc_read_word(PKTRAM_ADDR + 4), PKTRAM_ADDR + 4);
+	zassert_equal(rc_read_word(PKTRAM_ADDR + 28), PKTRAM_ADDR + 28);
+
+	/* One line fill for both reads */
+	zassert_equal(num_xfers, 1);
+	zassert_false(xfers[0].write);
+	zassert_false(xfers[0].hl);
+	zassert_equal(xfers[0].addr, PKTRAM_ADDR);
+	zassert_equal(xfers[0].len, LINE_SIZE);
+
+	zep_shim_rc_stats_get(&after);
+	zassert_equal(after.misses - before.misses, 1);
+	zassert_equal(after.hits - before.hits, 1);
+}
+
+ZTEST(bus_cache, test_rc_hl_fill)
+{
+	zassert_equal(rc_read_word(GRAM_ADDR), GRAM_ADDR);
+
+	zassert_equal(num_xfers, 1);
+	zassert_true(xfers[0].hl);
+	zassert_equal(xfers[0].addr, GRAM_ADDR);
+}
+
+ZTEST(bus_cache, test_rc_read_across_lines)
+{
+	uint32_t val[2];
+
+	zassert_true(zep_shim_rc_read(&mock_dev, PKTRAM_ADDR + 28, val, sizeof(val)));
+
+	zassert_equal(num_xfers, 2);
+	zassert_equal(xfers[0].addr, PKTRAM_ADDR);
+	zassert_equal(xfers[1].addr, PKTRAM_ADDR + LINE_SIZE);
+	zassert_equal(val[0], PKTRAM_ADDR + 28);
+	zassert_equal(val[1], PKTRAM_ADDR + 32);
+}
+
+ZTEST(bus_cache, test_rc_invalidate_overlap)
+{
+	rc_read_word(PKTRAM_ADDR);
+	rc_read_word(PKTRAM_ADDR + LINE_SIZE);
+	zassert_equal(num_xfers, 2);
+
+	/* Ranges ending at a line or starting after it keep it */
+	zep_shim_rc_invalidate(PKTRAM_ADDR - 4, 4);
+	zep_shim_rc_invalidate(PKTRAM_ADDR + 2 * LINE_SIZE, 4);
+	rc_read_word(PKTRAM_ADDR);
+	rc_read_word(PKTRAM_ADDR + LINE_SIZE);
+	zassert_equal(num_xfers, 2);
+
+	/* A range covering the last word of a line only drops that line */
+	zep_shim_rc_invalidate(PKTRAM_ADDR + LINE_SIZE - 4, 4);
+	rc_read_word(PKTRAM_ADDR + LINE_SIZE);
+	zassert_equal(num_xfers, 2);
+	rc_read_word(PKTRAM_ADDR);
+	zassert_equal(num_xfers, 3);
+	zassert_equal(xfers[2].addr, PKTRAM_ADDR);
+
+	/* A range straddling two lines drops both */
+	zep_shim_rc_invalidate(PKTRAM_ADDR + LINE_SIZE - 2, 4);
+	rc_read_word(PKTRAM_ADDR);
+	rc_read_word(PKTRAM_ADDR + LINE_SIZE);
+	zassert_equal(num_xfers, 5);
+}
+
+ZTEST(bus_cache, test_rc_invalidate_all)
+{
+	rc_read_word(PKTRAM_ADDR);
+	zep_shim_rc_invalidate_all();
+	rc_read_word(PKTRAM_ADDR);
+
+	zassert_equal(num_xfers, 2);
+}
+
+ZTEST(bus_cache, test_rc_eviction)
+{
+	/* Four lines, direct mapped: lines 4 apart share an entry */
+	rc_read_word(PKTRAM_ADDR);
+	rc_read_word(PKTRAM_ADDR + 4 * LINE_SIZE);
+	rc_read_word(PKTRAM_ADDR);
+
+	zassert_equal(num_xfers, 3);
+}
+
+ZTEST(bus_cache, test_rc_bypass)
+{
+	uint32_t buf[LINE_SIZE / 4 + 1];
+	uint32_t val;
+
+	/* Not in a cacheable region */
+	zassert_false(zep_shim_rc_read(&mock_dev, 0x000000, &val, 4));
+
+	/* Longer than a line */
+	zassert_false(zep_shim_rc_read(&mock_dev, PKTRAM_ADDR, buf, sizeof(buf)));
+
+	/* Disabled without the host interrupt */
+	zep_shim_rc_enable(false);
+	zassert_false(zep_shim_rc_read(&mock_dev, PKTRAM_ADDR, &val, 4));
+
+	zassert_equal(num_xfers, 0);
+}
+
+ZTEST_SUITE(bus_cache, NULL, NULL, bus_cache_before, NULL, NULL);
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Tests of the chunking and prioritization of the bus owner thread.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+
+#include "bus_owner.h"
+
+LOG_MODULE_REGISTER(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
+
+#define CHUNK_SIZE CONFIG_NRF700X_BUS_OWNER_CHUNK_SIZE
+#define MAX_XFERS 8
+#define STACK_SIZE 1024
+
+/**
+ * struct bus_xfer - Bus access seen by the mock bus device.
+ * @write: Access is a write.
+ * @addr: RPU address.
+ * @data: Host buffer.
+ * @len: Length in bytes.
+ * @tid: Thread that issued the access.
+ * @held: Issued while the bus was held with bus_begin.
+ */
+struct bus_xfer {
+	bool write;
+	unsigned int addr;
+	void *data;
+	int len;
+	k_tid_t tid;
+	bool held;
+};
+
+static struct bus_xfer xfers[MAX_XFERS];
+static int num_xfers;
+
+/* bus_begin nesting and number of outermost calls */
+static int bus_depth;
+static int bus_begins;
+
+/* Failure injected on the access with this index, -1 for none */
+static int fail_at;
+
+/* Set to hold the next access until the gate is given */
+static bool gate_armed;
+static K_SEM_DEFINE(gate_entered, 0, 1);
+static K_SEM_DEFINE(gate, 0, 1);
+
+static struct qspi_dev *dev;
+
+K_THREAD_STACK_DEFINE(bulk_stack, STACK_SIZE);
+K_THREAD_STACK_DEFINE(small_stack, STACK_SIZE);
+static struct k_thread bulk_thread;
+static struct k_thread small_thread;
+
+static int mock_xfer(bool write, unsigned int addr, void *data, int len)
+{
+	struct bus_xfer *xfer;
+	uint32_t *words = data;
+	int i;
+
+	zassert_true(num_xfers < MAX_XFERS);
+
+	xfer = &xfers[num_xfers];
+	xfer->write = write;
+	xfer->addr = addr;
+	xfer->data = data;
+	xfer->len = len;
+	xfer->tid = k_current_get();
+	xfer->held = bus_depth > 0;
+
+	if (gate_armed) {
+		gate_armed = false;
+		k_sem_give(&gate_entered);
+		k_sem_take(&gate, K_FOREVER);
+	}
+
+	/* RPU memory reads back the address of each word */
+	for (i = 0; !write && (i < len / 4); i++) {
+		words[i] = addr + i * 4;
+	}
+
+	return (num_xfers++ == fail_at) ? -EIO : 0;
+}
+
+static int mock_read(unsigned int addr, void *data, int len)
+{
+	return mock_xfer(false, addr, data, len);
+}
+
+static int mock_write(unsigned int addr, const void *data, int len)
+{
+	return mock_xfer(true, addr, (void *)data, len);
+}
+
+static int mock_hl_read(unsigned int addr, void *data, int len, unsigned int latency)
+{
+	return mock_xfer(false, addr, data, len);
+}
+
+static int mock_bus_begin(void)
+{
+	if (!bus_depth++) {
+		bus_begins++;
+	}
+
+	return 0;
+}
+
+static void mock_bus_end(void)
+{
+	bus_depth--;
+}
+
+static struct qspi_dev mock_dev = {
+	.read = mock_read,
+	.write = mock_write,
+	.hl_read = mock_hl_read,
+	.bus_begin = mock_bus_begin,
+	.bus_end = mock_bus_end,
+};
+
+static void assert_xfer(int i, bool write, unsigned int addr, int len)
+{
+	zassert_true(i < num_xfers, "xfer %d missing", i);
+	zassert_equal(xfers[i].write, write, "xfer %d", i);
+	zassert_equal(xfers[i].addr, addr, "xfer %d", i);
+	zassert_equal(xfers[i].len, len, "xfer %d", i);
+}
+
+static void *bus_owner_setup(void)
+{
+	dev = bus_owner_dev(&mock_dev);
+
+	return NULL;
+}
+
+static void bus_owner_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	num_xfers = 0;
+	bus_begins = 0;
+	fail_at = -1;
+	gate_armed = false;
+}
+
+ZTEST(bus_owner, test_read_chunks)
+{
+	struct bus_owner_stats before, after;
+	uint32_t buf[10];
+	int i;
+
+	bus_owner_stats_get(&before);
+
+	zassert_ok(dev->read(0x1000, buf, sizeof(buf)));
+
+	zassert_equal(num_xfers, 3);
+	assert_xfer(0, false, 0x1000, CHUNK_SIZE);
+	assert_xfer(1, false, 0x1010, CHUNK_SIZE);
+	assert_xfer(2, false, 0x1020, 8);
+	zassert_equal_ptr(xfers[1].data, (uint8_t *)buf + CHUNK_SIZE);
+	zassert_not_equal(xfers[0].tid, k_current_get());
+
+	for (i = 0; i < ARRAY_SIZE(buf); i++) {
+		zassert_equal(buf[i], 0x1000 + i * 4);
+	}
+
+	bus_owner_stats_get(&after);
+	zassert_equal(after.normal - before.normal, 1);
+	zassert_equal(after.preempt - before.preempt, 0);
+}
+
+ZTEST(bus_owner, test_chunks_hold_bus)
+{
+	uint32_t buf[10];
+	int i;
+
+	zassert_ok(dev->write(0x2000, buf, sizeof(buf)));
+
+	/* One bracket around all the chunks, closed again */
+	zassert_equal(num_xfers, 3);
+	zassert_equal(bus_begins, 1);
+	zassert_equal(bus_depth, 0);
+
+	for (i = 0; i < num_xfers; i++) {
+		zassert_true(xfers[i].held, "xfer %d", i);
+	}
+
+	/* Single chunk transfers need no bracket */
+	zassert_ok(dev->write(0x2000, buf, CHUNK_SIZE));
+	zassert_equal(bus_begins, 1);
+	zassert_false(xfers[3].held);
+}
+
+ZTEST(bus_owner, test_write_chunks)
+{
+	uint32_t buf[8] = { 0 };
+
+	zassert_ok(dev->write(0x2000, buf, sizeof(buf)));
+
+	zassert_equal(num_xfers, 2);
+	assert_xfer(0, true, 0x2000, CHUNK_SIZE);
+	assert_xfer(1, true, 0x2010, CHUNK_SIZE);
+}
+
+ZTEST(bus_owner, test_chunk_error)
+{
+	uint32_t buf[12];
+
+	fail_at = 1;
+
+	/* The chunks after a failed one are not issued */
+	zassert_equal(dev->read(0x1000, buf, sizeof(buf)), -EIO);
+	zassert_equal(num_xfers, 2);
+}
+
+ZTEST(bus_owner, test_small_requests_whole)
+{
+	struct bus_owner_stats before, after;
+	uint32_t buf[8];
+
+	bus_owner_stats_get(&before);
+
+	/* High priority requests are never split */
+	zassert_ok(dev->read(0x1000, buf, CHUNK_SIZE));
+	zassert_ok(dev->hl_read(0x3000, buf, sizeof(buf), 1));
+
+	zassert_equal(num_xfers, 2);
+	assert_xfer(0, false, 0x1000, CHUNK_SIZE);
+	assert_xfer(1, false, 0x3000, sizeof(buf));
+
+	bus_owner_stats_get(&after);
+	zassert_equal(after.high - before.high, 2);
+}
+
+static void bulk_read(void *p1, void *p2, void *p3)
+{
+	static uint32_t buf[10];
+
+	zassert_ok(dev->read(0x1000, buf, sizeof(buf)));
+}
+
+static void small_read(void *p1, void *p2, void *p3)
+{
+	uint32_t val;
+
+	zassert_ok(dev->read(0x4000, &val, sizeof(val)));
+	zassert_equal(val, 0x4000);
+}
+
+ZTEST(bus_owner, test_high_between_chunks)
+{
+	struct bus_owner_stats before, after;
+
+	bus_owner_stats_get(&before);
+
+	/* Hold the first chunk of a bulk read on the bus */
+	gate_armed = true;
+	k_thread_create(&bulk_thread, bulk_stack, K_THREAD_STACK_SIZEOF(bulk_stack), bulk_read,
+			NULL, NULL, NULL, K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+	zassert_ok(k_sem_take(&gate_entered, K_MSEC(100)));
+
+	/* Queue a small read meanwhile */
+	k_thread_create(&small_thread, small_stack, K_THREAD_STACK_SIZEOF(small_stack), small_read,
+			NULL, NULL, NULL, K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+	k_sleep(K_MSEC(1));
+	zassert_equal(num_xfers, 0);
+
+	k_sem_give(&gate);
+
+	zassert_ok(k_thread_join(&bulk_thread, K_MSEC(100)));
+	zassert_ok(k_thread_join(&small_thread, K_MSEC(100)));
+
+	/* Served right after the chunk in progress */
+	zassert_equal(num_xfers, 4);
+	assert_xfer(0, false, 0x1000, CHUNK_SIZE);
+	assert_xfer(1, false, 0x4000, 4);
+	assert_xfer(2, false, 0x1010, CHUNK_SIZE);
+	assert_xfer(3, false, 0x1020, 8);
+
+	bus_owner_stats_get(&after);
+	zassert_equal(after.preempt - before.preempt, 1);
+}
+
+ZTEST(bus_owner, test_bracket_bypass)
+{
+	struct bus_owner_stats before, after;
+	uint32_t buf[10];
+
+	bus_owner_stats_get(&before);
+
+	zassert_ok(dev->bus_begin());
+	zassert_ok(dev->read(0x1000, buf, sizeof(buf)));
+	dev->bus_end();
+
+	/* Issued directly by the holder, in one piece */
+	zassert_equal(num_xfers, 1);
+	assert_xfer(0, false, 0x1000, sizeof(buf));
+	zassert_equal(xfers[0].tid, k_current_get());
+
+	bus_owner_stats_get(&after);
+	zassert_equal(after.direct - before.direct, 1);
+
+	/* Queued again once the bracket is closed */
+	zassert_ok(dev->read(0x1000, buf, sizeof(buf)));
+	zassert_equal(num_xfers, 4);
+	zassert_not_equal(xfers[1].tid, k_current_get());
+}
+
+ZTEST_SUITE(bus_owner, NULL, bus_owner_setup, bus_owner_before, NULL, NULL);
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Simulated nRF70 on the SPI emulator.
+ */
+
+#define DT_DRV_COMPAT test_nrf70_spi_emul
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+
+#include "nrf70_spi_emul.h"
+
+#define NRF70_EMUL_MEM_SIZE 0x340000
+#define NRF70_EMUL_ADDR_MASK 0x3FFFFF
+/* Incrementing address mode, fixed address mode repeats the first word */
+#define NRF70_EMUL_ADDR_INCR BIT(23)
+/* Reads below PKTRAM are preceded by the slave latency words */
+#define NRF70_EMUL_HL_END 0x0C0000
+/* Chip select and driver setup of each transaction */
+#define NRF70_EMUL_XFER_OVERHEAD_NS 2000
+
+#define NRF70_EMUL_OP_PP 0x02
+#define NRF70_EMUL_OP_FASTREAD 0x0b
+#define NRF70_EMUL_FASTREAD_HDR 5
+
+static uint8_t nrf70_emul_ram[NRF70_EMUL_MEM_SIZE];
+static struct nrf70_emul_stats nrf70_emul_stats;
+
+/* Wire time not yet waited for, below the busy wait resolution */
+static uint64_t nrf70_emul_ns;
+
+static size_t buf_set_len(const struct spi_buf_set *set)
+{
+	size_t len = 0;
+	int i;
+
+	for (i = 0; set && (i < set->count); i++) {
+		len += set->buffers[i].len;
+	}
+
+	return len;
+}
+
+/* Byte i of a buffer set, buffers without data clock out zeros */
+static uint8_t tx_byte(const struct spi_buf_set *tx, size_t i)
+{
+	const struct spi_buf *buf;
+	int n;
+
+	for (n = 0; n < tx->count; n++) {
+		buf = &tx->buffers[n];
+
+		if (i < buf->len) {
+			return buf->buf ? ((const uint8_t *)buf->buf)[i] : 0;
+		}
+
+		i -= buf->len;
+	}
+
+	return 0;
+}
+
+static void rx_put(const struct spi_buf_set *rx, size_t i, uint8_t val)
+{
+	const struct spi_buf *buf;
+	int n;
+
+	for (n = 0; n < rx->count; n++) {
+		buf = &rx->buffers[n];
+
+		if (i < buf->len) {
+			if (buf->buf) {
+				((uint8_t *)buf->buf)[i] = val;
+			}
+
+			return;
+		}
+
+		i -= buf->len;
+	}
+}
+
+static unsigned int nrf70_emul_latency(const struct spi_config *config)
+{
+	/* As the SPIM backend expects it */
+	return (config->frequency >= MHZ(16)) ? 1 : 0;
+}
+
+static int nrf70_emul_io(const struct emul *target, const struct spi_config *config,
+			 const struct spi_buf_set *tx, const struct spi_buf_set *rx)
+{
+	size_t tx_len = buf_set_len(tx);
+	size_t rx_len = buf_set_len(rx);
+	size_t len = MAX(tx_len, rx_len);
+	uint32_t hdr, addr, off;
+	size_t data, i;
+
+	ARG_UNUSED(target);
+
+	if (tx_len < 4) {
+		return -EINVAL;
+	}
+
+	hdr = (tx_byte(tx, 1) << 16) | (tx_byte(tx, 2) << 8) | tx_byte(tx, 3);
+	addr = hdr & NRF70_EMUL_ADDR_MASK;
+
+	switch (tx_byte(tx, 0)) {
+	case NRF70_EMUL_OP_PP:
+		if (addr + tx_len - 4 > NRF70_EMUL_MEM_SIZE) {
+			return -EIO;
+		}
+
+		for (i = 4; i < tx_len; i++) {
+			nrf70_emul_ram[addr + i - 4] = tx_byte(tx, i);
+		}
+		break;
+	case NRF70_EMUL_OP_FASTREAD:
+		data = NRF70_EMUL_FASTREAD_HDR;
+
+		if (addr < NRF70_EMUL_HL_END) {
+			data += 4 * nrf70_emul_latency(config);
+		}
+
+		if ((rx_len > data) && (addr + rx_len - data > NRF70_EMUL_MEM_SIZE)) {
+			return -EIO;
+		}
+
+		for (i = 0; i < rx_len; i++) {
+			if (i < data) {
+				rx_put(rx, i, 0);
+				continue;
+			}
+
+			off = i - data;
+
+			if (!(hdr & NRF70_EMUL_ADDR_INCR)) {
+				off %= 4;
+			}
+
+			rx_put(rx, i, nrf70_emul_ram[addr + off]);
+		}
+		break;
+	default:
+		/* Status register commands read back as zero */
+		for (i = 0; i < rx_len; i++) {
+			rx_put(rx, i, 0);
+		}
+		break;
+	}
+
+	nrf70_emul_stats.xfers++;
+	nrf70_emul_stats.wire_bytes += len;
+
+	nrf70_emul_ns += NRF70_EMUL_XFER_OVERHEAD_NS +
+			 ((uint64_t)len * 8 * NSEC_PER_SEC) / config->frequency;
+	k_busy_wait(nrf70_emul_ns / NSEC_PER_USEC);
+	nrf70_emul_ns %= NSEC_PER_USEC;
+
+	return 0;
+}
+
+void nrf70_emul_stats_get(struct nrf70_emul_stats *stats)
+{
+	*stats = nrf70_emul_stats;
+}
+
+void nrf70_emul_stats_reset(void)
+{
+	memset(&nrf70_emul_stats, 0, sizeof(nrf70_emul_stats));
+}
+
+void nrf70_emul_mem_fill(uint32_t addr, size_t len)
+{
+	uint32_t val;
+	size_t i;
+
+	for (i = 0; i < len; i += 4) {
+		val = addr + i;
+		memcpy(&nrf70_emul_ram[addr + i], &val, 4);
+	}
+}
+
+uint8_t *nrf70_emul_mem(uint32_t addr)
+{
+	return &nrf70_emul_ram[addr];
+}
+
+static int nrf70_emul_init(const struct emul *target, const struct device *parent)
+{
+	ARG_UNUSED(target);
+	ARG_UNUSED(parent);
+
+	return 0;
+}
+
+static struct spi_emul_api nrf70_emul_api = {
+	.io = nrf70_emul_io,
+};
+
+DEVICE_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL,
+		      CONFIG_APPLICATION_INIT_PRIORITY, NULL);
+
+EMUL_DT_INST_DEFINE(0, nrf70_emul_init, NULL, NULL, &nrf70_emul_api, NULL);
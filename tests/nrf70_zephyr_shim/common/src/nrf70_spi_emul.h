@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Simulated nRF70 on the SPI emulator.
+ *
+ * Serves the PP and FASTREAD commands of the SPIM backend from a RAM copy
+ * of the RPU address space, with slave latency words before high-latency
+ * data, and takes the simulated time the transfer would take on the wire.
+ */
+
+#ifndef __NRF70_SPI_EMUL_H__
+#define __NRF70_SPI_EMUL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * struct nrf70_emul_stats - Simulated device statistics.
+ * @xfers: Number of SPI transactions.
+ * @wire_bytes: Bytes clocked on the bus, headers and latency included.
+ */
+struct nrf70_emul_stats {
+	uint32_t xfers;
+	uint32_t wire_bytes;
+};
+
+void nrf70_emul_stats_get(struct nrf70_emul_stats *stats);
+void nrf70_emul_stats_reset(void);
+
+/* Fill RPU memory with the address of each word */
+void nrf70_emul_mem_fill(uint32_t addr, size_t len);
+
+/* Host view of RPU memory at addr */
+uint8_t *nrf70_emul_mem(uint32_t addr);
+
+#endif /* __NRF70_SPI_EMUL_H__ */
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Tests of the ordering and merging of vectored QSPI transfers.
+ */
+
+#include <zephyr/ztest.h>
+
+#include "qspi_if.h"
+
+static uint8_t buf[64] __aligned(4);
+static uint8_t order_buf[QSPI_SEG_SORT_MAX];
+
+ZTEST(qspi_seg, test_run_merges_contiguous)
+{
+	const struct qspi_seg segs[] = {
+		{ 0x1000, &buf[0], 8 },
+		{ 0x1008, &buf[8], 4 },
+		{ 0x100C, &buf[12], 16 },
+	};
+	int n;
+
+	zassert_equal(qspi_seg_run(segs, NULL, 0, ARRAY_SIZE(segs), &n), 28);
+	zassert_equal(n, 3);
+}
+
+ZTEST(qspi_seg, test_run_stops_at_rpu_gap)
+{
+	const struct qspi_seg segs[] = {
+		{ 0x1000, &buf[0], 8 },
+		{ 0x1010, &buf[8], 8 },
+	};
+	int n;
+
+	zassert_equal(qspi_seg_run(segs, NULL, 0, ARRAY_SIZE(segs), &n), 8);
+	zassert_equal(n, 1);
+	zassert_equal(qspi_seg_run(segs, NULL, 1, ARRAY_SIZE(segs), &n), 8);
+	zassert_equal(n, 1);
+}
+
+ZTEST(qspi_seg, test_run_stops_at_host_gap)
+{
+	const struct qspi_seg segs[] = {
+		{ 0x1000, &buf[0], 8 },
+		{ 0x1008, &buf[16], 8 },
+	};
+	int n;
+
+	zassert_equal(qspi_seg_run(segs, NULL, 0, ARRAY_SIZE(segs), &n), 8);
+	zassert_equal(n, 1);
+}
+
+ZTEST(qspi_seg, test_run_keeps_partial_words)
+{
+	const struct qspi_seg segs[] = {
+		{ 0x1000, &buf[0], 8 },
+		{ 0x1008, &buf[8], 6 },
+		{ 0x100E, &buf[14], 2 },
+	};
+	int n;
+
+	/* A partial word can end a run but nothing is merged after it */
+	zassert_equal(qspi_seg_run(segs, NULL, 0, ARRAY_SIZE(segs), &n), 8);
+	zassert_equal(n, 1);
+	zassert_equal(qspi_seg_run(segs, NULL, 1, ARRAY_SIZE(segs), &n), 6);
+	zassert_equal(n, 1);
+}
+
+ZTEST(qspi_seg, test_order_sorts_by_address)
+{
+	const struct qspi_seg segs[] = {
+		{ 0x1010, &buf[16], 8 },
+		{ 0x1000, &buf[0], 8 },
+		{ 0x1008, &buf[8], 8 },
+	};
+	const uint8_t *order;
+	int n;
+
+	order = qspi_seg_order(segs, ARRAY_SIZE(segs), false, order_buf);
+
+	zassert_not_null(order);
+	zassert_equal(order[0], 1);
+	zassert_equal(order[1], 2);
+	zassert_equal(order[2], 0);
+
+	/* Sorted, the segments form a single run */
+	zassert_equal(qspi_seg_run(segs, order, 0, ARRAY_SIZE(segs), &n), 24);
+	zassert_equal(n, 3);
+}
+
+ZTEST(qspi_seg, test_order_is_stable)
+{
+	const struct qspi_seg segs[] = {
+		{ 0x1004, &buf[0], 4 },
+		{ 0x1000, &buf[4], 4 },
+		{ 0x1004, &buf[8], 4 },
+	};
+	const uint8_t *order;
+
+	order = qspi_seg_order(segs, ARRAY_SIZE(segs), false, order_buf);
+
+	zassert_not_null(order);
+	zassert_equal(order[0], 1);
+	zassert_equal(order[1], 0);
+	zassert_equal(order[2], 2);
+}
+
+ZTEST(qspi_seg, test_order_keeps_overlapping_writes)
+{
+	const struct qspi_seg segs[] = {
+		{ 0x1008, &buf[0], 8 },
+		{ 0x1000, &buf[8], 12 },
+	};
+
+	/* Reordering would change which write lands last */
+	zassert_is_null(qspi_seg_order(segs, ARRAY_SIZE(segs), true, order_buf));
+	zassert_not_null(qspi_seg_order(segs, ARRAY_SIZE(segs), false, order_buf));
+}
+
+ZTEST(qspi_seg, test_order_limits)
+{
+	struct qspi_seg segs[QSPI_SEG_SORT_MAX + 1];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(segs); i++) {
+		segs[i].addr = 0x2000 - i * 4;
+		segs[i].data = &buf[i * 4];
+		segs[i].len = 4;
+	}
+
+	zassert_is_null(qspi_seg_order(segs, 1, false, order_buf));
+	zassert_is_null(qspi_seg_order(segs, ARRAY_SIZE(segs), false, order_buf));
+	zassert_not_null(qspi_seg_order(segs, QSPI_SEG_SORT_MAX, false, order_buf));
+}
+
+ZTEST_SUITE(qspi_seg, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Sweep of unaligned QSPI span reads.
+ *
+ * EasyDMA only reads whole words at word-aligned addresses, so every read
+ * that is not is served by qspi_span_read() through the bounce buffer.
+ * The sweep covers RPU offsets 0-3 against lengths up to past two bounce
+ * buffers, checks the data and reports the transactions and the bytes
+ * they clock per point.
+ */
+
+#include <string.h>
+
+#include <zephyr/ztest.h>
+
+#include "qspi_if.h"
+
+#define RPU_SIZE 1024
+#define BOUNCE_SIZE 64
+#define SWEEP_MAX_LEN (2 * BOUNCE_SIZE + 8)
+#define GUARD 0xEE
+
+/**
+ * struct span_stats - Reads seen by the mock bus.
+ * @xfers: Number of reads.
+ * @wire_bytes: Bytes read, as they would be clocked on the bus.
+ */
+struct span_stats {
+	int xfers;
+	size_t wire_bytes;
+};
+
+static uint8_t rpu_mem[RPU_SIZE];
+static uint32_t bounce[BOUNCE_SIZE / 4];
+static uint8_t dest[SWEEP_MAX_LEN + 2];
+
+static int mock_read(void *ctx, unsigned int addr, void *buf, size_t len)
+{
+	struct span_stats *stats = ctx;
+
+	zassert_equal(addr % 4, 0, "addr %u", addr);
+	zassert_equal(len % 4, 0, "len %u", len);
+	zassert_true(len <= sizeof(bounce), "len %u", len);
+	zassert_true(addr + len <= sizeof(rpu_mem));
+
+	memcpy(buf, &rpu_mem[addr], len);
+
+	stats->xfers++;
+	stats->wire_bytes += len;
+
+	return 0;
+}
+
+static int mock_read_fail(void *ctx, unsigned int addr, void *buf, size_t len)
+{
+	struct span_stats *stats = ctx;
+
+	/* The second chunk fails */
+	if (stats->xfers == 1) {
+		stats->xfers++;
+		return -EIO;
+	}
+
+	return mock_read(ctx, addr, buf, len);
+}
+
+static void *qspi_span_setup(void)
+{
+	int i;
+
+	for (i = 0; i < sizeof(rpu_mem); i++) {
+		rpu_mem[i] = (i * 7) ^ (i >> 8);
+	}
+
+	return NULL;
+}
+
+ZTEST(qspi_span, test_sweep)
+{
+	struct span_stats stats;
+	unsigned int off, addr;
+	size_t len;
+
+	printk("offset,len,xfers,wire_bytes\n");
+
+	for (off = 0; off < 4; off++) {
+		for (len = 1; len <= SWEEP_MAX_LEN; len++) {
+			addr = 0x100 + off;
+			memset(&stats, 0, sizeof(stats));
+			memset(dest, GUARD, sizeof(dest));
+
+			/* The host buffer is not word aligned either */
+			zassert_ok(qspi_span_read(addr, &dest[1], len, bounce, sizeof(bounce),
+						  mock_read, &stats));
+
+			zassert_mem_equal(&dest[1], &rpu_mem[addr], len, "off %u len %u", off,
+					  len);
+			zassert_equal(dest[0], GUARD);
+			zassert_equal(dest[len + 1], GUARD, "off %u len %u", off, len);
+
+			/* One read per bounce buffer of the covering span */
+			zassert_equal(stats.xfers, DIV_ROUND_UP(off + len, BOUNCE_SIZE),
+				      "off %u len %u", off, len);
+			zassert_equal(stats.wire_bytes, ROUND_UP(off + len, 4),
+				      "off %u len %u", off, len);
+
+			if ((len <= 8) || !(len % 32)) {
+				printk("%u,%u,%d,%u\n", off, len, stats.xfers, stats.wire_bytes);
+			}
+		}
+	}
+}
+
+ZTEST(qspi_span, test_read_error)
+{
+	struct span_stats stats = { 0 };
+
+	zassert_equal(qspi_span_read(0x101, dest, 2 * BOUNCE_SIZE, bounce, sizeof(bounce),
+				     mock_read_fail, &stats), -EIO);
+	zassert_equal(stats.xfers, 2);
+}
+
+ZTEST_SUITE(qspi_span, NULL, qspi_span_setup, NULL, NULL, NULL);
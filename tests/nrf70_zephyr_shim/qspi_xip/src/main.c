@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Tests of the QSPI XIP read mode against a host mapped window.
+ *
+ * The window is an anonymous mapping covering the RPU address space. Only
+ * PKTRAM is readable, so a mapped read of any other block faults just as
+ * it would return garbage on the bus.
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include <zephyr/ztest.h>
+
+#include "rpu_hw_if.h"
+#include "qspi_if.h"
+
+#define XIP_WINDOW_SIZE 0x400000
+#define PKTRAM_START 0x0C0000
+#define PKTRAM_END 0x0F1000
+
+static uint8_t *window;
+
+/* Bus configuration, as device.c provides it */
+static struct qspi_config test_cfg = {
+	.qspi_slave_latency = 1,
+};
+
+struct qspi_config *qspi_get_config(void)
+{
+	return &test_cfg;
+}
+
+static uint32_t pattern(uint32_t addr)
+{
+	return addr ^ 0xA5A5A5A5;
+}
+
+static void *xip_setup(void)
+{
+	uint32_t addr;
+
+	window = mmap(NULL, XIP_WINDOW_SIZE, PROT_NONE,
+		      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	zassert_not_equal(window, MAP_FAILED);
+
+	zassert_ok(mprotect(window + PKTRAM_START, PKTRAM_END - PKTRAM_START,
+			    PROT_READ | PROT_WRITE));
+
+	for (addr = PKTRAM_START; addr < PKTRAM_END; addr += 4) {
+		*(uint32_t *)(window + addr) = pattern(addr);
+	}
+
+	return NULL;
+}
+
+static void xip_teardown(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	munmap(window, XIP_WINDOW_SIZE);
+}
+
+/* Read as rpu_read() does, XIP where the plan allows it */
+static int xip_read(uint32_t addr, void *data, uint32_t len)
+{
+	struct rpu_access acc;
+	uint8_t *dst = data;
+	int rc;
+
+	while (len) {
+		rc = rpu_plan(addr, len, &acc);
+		if (rc)
+			return rc;
+		if (!acc.xip)
+			return -ENOTSUP;
+		qspi_xip_copy(window, addr, dst, acc.len);
+		addr += acc.len;
+		dst += acc.len;
+		len -= acc.len;
+	}
+
+	return 0;
+}
+
+ZTEST(qspi_xip, test_only_pktram)
+{
+	int i;
+
+	for (i = 0; i < NUM_MEM_BLOCKS; i++) {
+		zassert_equal(rpu_addr_xip_capable(rpu_7002_memmap[i][0], 4), i == PKTRAM,
+			      "block %d", i);
+	}
+
+	zassert_true(rpu_addr_xip_capable(PKTRAM_END - 4, 4));
+	zassert_false(rpu_addr_xip_capable(PKTRAM_END - 4, 8));
+}
+
+ZTEST(qspi_xip, test_copy)
+{
+	uint32_t buf[17];
+	uint8_t *dst = (uint8_t *)buf + 1;
+	uint32_t val;
+	int i;
+
+	zassert_ok(xip_read(PKTRAM_START + 0x100, dst, 64));
+
+	for (i = 0; i < 16; i++) {
+		memcpy(&val, dst + i * 4, 4);
+		zassert_equal(val, pattern(PKTRAM_START + 0x100 + i * 4));
+	}
+}
+
+ZTEST(qspi_xip, test_copy_end)
+{
+	uint32_t buf[4];
+	int i;
+
+	zassert_ok(xip_read(PKTRAM_END - sizeof(buf), buf, sizeof(buf)));
+
+	for (i = 0; i < ARRAY_SIZE(buf); i++) {
+		zassert_equal(buf[i], pattern(PKTRAM_END - sizeof(buf) + i * 4));
+	}
+}
+
+ZTEST(qspi_xip, test_rejects_other_blocks)
+{
+	uint32_t buf[4];
+
+	/* High latency GRAM, then LMAC RAM which has none but is not
+	 * specified for mapped reads.
+	 */
+	zassert_equal(xip_read(0x080000, buf, sizeof(buf)), -ENOTSUP);
+	zassert_equal(xip_read(0x140000, buf, sizeof(buf)), -ENOTSUP);
+	zassert_equal(xip_read(PKTRAM_END - 8, buf, sizeof(buf)), -EINVAL);
+}
+
+ZTEST(qspi_xip, test_sees_rpu_writes)
+{
+	uint32_t addr = PKTRAM_START + 0x40;
+	uint32_t val;
+
+	zassert_ok(xip_read(addr, &val, 4));
+	zassert_equal(val, pattern(addr));
+
+	/* The RPU updates its memory behind the window */
+	*(volatile uint32_t *)(window + addr) = 0x12345678;
+
+	zassert_ok(xip_read(addr, &val, 4));
+	zassert_equal(val, 0x12345678);
+
+	*(volatile uint32_t *)(window + addr) = pattern(addr);
+}
+
+ZTEST_SUITE(qspi_xip, NULL, xip_setup, NULL, NULL, xip_teardown);
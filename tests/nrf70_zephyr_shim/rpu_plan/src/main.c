@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief Tests of the planning of accesses to RPU memory.
+ */
+
+#include <zephyr/ztest.h>
+
+#include "rpu_hw_if.h"
+#include "qspi_if.h"
+
+/* Bus configuration, as device.c provides it */
+static struct qspi_config test_cfg = {
+	.qspi_slave_latency = 1,
+};
+
+struct qspi_config *qspi_get_config(void)
+{
+	return &test_cfg;
+}
+
+ZTEST(rpu_plan, test_block_starts)
+{
+	struct rpu_access acc;
+	int i;
+
+	for (i = 0; i < NUM_MEM_BLOCKS; i++) {
+		zassert_ok(rpu_plan(rpu_7002_memmap[i][0], 4, &acc), "%s", blk_name[i]);
+		zassert_equal(acc.blk, i, "%s", blk_name[i]);
+		zassert_equal(acc.len, 4, "%s", blk_name[i]);
+		zassert_equal(acc.hl, rpu_7002_memmap[i][0] < 0x0C0000, "%s", blk_name[i]);
+	}
+}
+
+ZTEST(rpu_plan, test_access_type)
+{
+	struct rpu_access acc;
+
+	zassert_ok(rpu_plan(0x080000, 4, &acc));
+	zassert_equal(acc.blk, GRAM);
+	zassert_true(acc.hl);
+	zassert_false(acc.xip);
+	zassert_true(acc.writable);
+
+	zassert_ok(rpu_plan(0x0C0000, 4, &acc));
+	zassert_equal(acc.blk, PKTRAM);
+	zassert_false(acc.hl);
+	zassert_true(acc.xip);
+
+	/* The firmware RAMs are read directly by the shell as well */
+	zassert_ok(rpu_plan(0x140000, 4, &acc));
+	zassert_equal(acc.blk, LMAC_RET_RAM);
+	zassert_false(acc.hl);
+	zassert_equal(acc.latency, 0);
+	/* No latency, but the window is only used for PKTRAM */
+	zassert_false(acc.xip);
+
+	zassert_ok(rpu_plan(0x100000, 4, &acc));
+	zassert_equal(acc.blk, LMAC_ROM);
+	zassert_false(acc.hl);
+	zassert_false(acc.writable);
+
+	zassert_ok(rpu_plan(0x200000, 4, &acc));
+	zassert_equal(acc.blk, UMAC_ROM);
+	zassert_false(acc.writable);
+}
+
+ZTEST(rpu_plan, test_latency_follows_clock)
+{
+	struct rpu_access acc;
+
+	zassert_ok(rpu_plan(0x009000, 4, &acc));
+	zassert_equal(acc.latency, 1);
+
+	zassert_ok(rpu_plan(0x0C0000, 4, &acc));
+	zassert_equal(acc.latency, 0);
+
+	/* Below 16 MHz the bus reads without latency words */
+	test_cfg.qspi_slave_latency = 0;
+	zassert_ok(rpu_plan(0x009000, 4, &acc));
+	zassert_true(acc.hl);
+	zassert_equal(acc.latency, 0);
+	test_cfg.qspi_slave_latency = 1;
+}
+
+ZTEST(rpu_plan, test_split_at_block_end)
+{
+	struct rpu_access acc;
+
+	/* SysBus ends at 0x008FFF, ExtSysBus follows directly */
+	zassert_ok(rpu_plan(0x008FF0, 0x40, &acc));
+	zassert_equal(acc.blk, SYSBUS);
+	zassert_equal(acc.len, 0x10);
+
+	zassert_ok(rpu_plan(0x009000, 0x30, &acc));
+	zassert_equal(acc.blk, EXT_SYS_BUS);
+	zassert_equal(acc.len, 0x30);
+
+	/* The end address of a block is inclusive */
+	zassert_ok(rpu_plan(0x0F0FFC, 0x10, &acc));
+	zassert_equal(acc.blk, PKTRAM);
+	zassert_equal(acc.len, 4);
+}
+
+ZTEST(rpu_plan, test_unmapped)
+{
+	struct rpu_access acc;
+
+	zassert_equal(rpu_plan(0x080000, 0, &acc), -EINVAL);
+
+	/* Unmapped page between GRAM and PKTRAM */
+	zassert_equal(rpu_plan(0x0A0000, 4, &acc), -EINVAL);
+
+	/* Past the end of GRAM within its last page */
+	zassert_equal(rpu_plan(0x092004, 4, &acc), -EINVAL);
+
+	/* Past the end of the map */
+	zassert_equal(rpu_plan(0x338004, 4, &acc), -EINVAL);
+	zassert_equal(rpu_plan(0x400000, 4, &acc), -EINVAL);
+}
+
+ZTEST(rpu_plan, test_cacheable)
+{
+	struct rpu_access acc;
+
+	zassert_ok(rpu_plan(0x0C0000, 32, &acc));
+	zassert_true(acc.cacheable);
+
+	zassert_ok(rpu_plan(0x080000, 32, &acc));
+	zassert_true(acc.cacheable);
+
+	zassert_ok(rpu_plan(0x000000, 32, &acc));
+	zassert_false(acc.cacheable);
+
+	zassert_true(rpu_addr_cacheable(0x0C0000, 32));
+	zassert_false(rpu_addr_cacheable(0x040000, 32));
+
+	/* Not cacheable as a whole when the range leaves the block */
+	zassert_false(rpu_addr_cacheable(0x0F0FE0, 64));
+}
+
+ZTEST(rpu_plan, test_xip_capable)
+{
+	zassert_true(rpu_addr_xip_capable(0x0C0000, 64));
+	zassert_false(rpu_addr_xip_capable(0x080000, 64));
+	zassert_false(rpu_addr_xip_capable(0x0F0FE0, 64));
+	zassert_false(rpu_addr_xip_capable(0x0A0000, 4));
+	zassert_false(rpu_addr_xip_capable(0x140000, 4));
+	zassert_false(rpu_addr_xip_capable(0x280000, 4));
+}
+
+ZTEST_SUITE(rpu_plan, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2024 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @file
+ * @brief SPIM backend microbenchmark against the simulated nRF70.
+ *
+ * Measures the bytes per second of spim_hl_read() one word per transaction
+ * and in bursts, and of spim_read() at two SPI clocks, together with the
+ * transactions and bytes the simulated device saw on the wire. The
+ * hl_speedup rows give the burst over single word throughput ratio and the
+ * transactions of both for each size.
+ *
+ * The simulated device does not charge for the driver work around a
+ * transaction, so the per-op overhead saved by spim_bus_begin() is taken
+ * from the host clock instead.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include <zephyr/ztest.h>
+#include <zephyr/logging/log.h>
+
+#include "qspi_if.h"
+#include "spi_if.h"
+#include "nrf70_spi_emul.h"
+
+LOG_MODULE_REGISTER(wifi_nrf_bus, CONFIG_WIFI_NRF700X_SHIM_BUS_LOG_LEVEL);
+
+#define PKTRAM_ADDR 0x0C0000
+#define GRAM_ADDR 0x080000
+#define BENCH_ITERATIONS 8
+#define BENCH_MAX_SIZE 1024
+#define BRACKET_OPS 256
+#define BRACKET_ROUNDS 5
+
+/**
+ * struct spim_bench_point - One measured point.
+ * @bytes_per_sec: Payload throughput.
+ * @xfers: SPI transactions per call.
+ * @wire_bytes: Bytes clocked on the bus per call.
+ */
+struct spim_bench_point {
+	uint32_t bytes_per_sec;
+	uint32_t xfers;
+	uint32_t wire_bytes;
+};
+
+static uint32_t bench_buf[BENCH_MAX_SIZE / 4];
+
+static void bench_check(uint32_t addr, int len)
+{
+	int i;
+
+	for (i = 0; i < len / 4; i++) {
+		zassert_equal(bench_buf[i], addr + i * 4, "word %d of %u", i, addr);
+	}
+}
+
+static void bench_run(const char *name, uint32_t addr, int len, bool hl,
+		      struct spim_bench_point *pt)
+{
+	struct nrf70_emul_stats stats;
+	uint32_t start, total;
+	int i;
+
+	nrf70_emul_mem_fill(addr, len);
+	nrf70_emul_stats_reset();
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < BENCH_ITERATIONS; i++) {
+		if (hl) {
+			zassert_ok(spim_hl_read(addr, bench_buf, len,
+						qspi_defconfig()->qspi_slave_latency));
+		} else {
+			zassert_ok(spim_read(addr, bench_buf, len));
+		}
+	}
+
+	total = k_cycle_get_32() - start;
+
+	bench_check(addr, len);
+
+	nrf70_emul_stats_get(&stats);
+
+	pt->bytes_per_sec = total ? (uint32_t)(((uint64_t)len * BENCH_ITERATIONS *
+						sys_clock_hw_cycles_per_sec()) / total) : 0;
+	pt->xfers = stats.xfers / BENCH_ITERATIONS;
+	pt->wire_bytes = stats.wire_bytes / BENCH_ITERATIONS;
+
+	printk("%s,%u,%d,%u,%u,%u\n", name, spim_get_freq() / MHZ(1), len, pt->bytes_per_sec,
+	       pt->xfers, pt->wire_bytes);
+}
+
+static void *spim_bench_setup(void)
+{
+	zassert_ok(qspi_dev()->init(qspi_defconfig()));
+
+	printk("path,freq_mhz,size,bytes_per_s,xfers,wire_bytes\n");
+
+	return NULL;
+}
+
+static void spim_bench_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	spim_hl_burst_set(false);
+	spim_set_freq(MHZ(8));
+}
+
+/* Typical event sizes read from the high-latency memories, and the largest */
+static const int hl_sizes[] = { 4, 32, 64, 128, 256, 512, BENCH_MAX_SIZE };
+
+ZTEST(spim_bench, test_hl_burst)
+{
+	struct spim_bench_point single, burst;
+	int i, len;
+
+	for (i = 0; i < ARRAY_SIZE(hl_sizes); i++) {
+		len = hl_sizes[i];
+
+		spim_hl_burst_set(false);
+		bench_run("hl_single", GRAM_ADDR, len, true, &single);
+
+		spim_hl_burst_set(true);
+		bench_run("hl_burst", GRAM_ADDR, len, true, &burst);
+
+		printk("hl_speedup,%u,%d,%u.%02u,%u,%u\n", spim_get_freq() / MHZ(1), len,
+		       burst.bytes_per_sec / single.bytes_per_sec,
+		       (burst.bytes_per_sec * 100 / single.bytes_per_sec) % 100, single.xfers,
+		       burst.xfers);
+		zassert_true(burst.bytes_per_sec >= single.bytes_per_sec);
+	}
+
+	/* One transaction per word, against one per MAX_WORDS words */
+	zassert_equal(single.xfers, BENCH_MAX_SIZE / 4);
+	zassert_equal(burst.xfers, BENCH_MAX_SIZE / 4 / CONFIG_NRF700X_HL_READ_BURST_MAX_WORDS);
+	zassert_true(burst.wire_bytes < single.wire_bytes / 2, "%u %u", burst.wire_bytes,
+		     single.wire_bytes);
+	zassert_true(burst.bytes_per_sec > 2 * single.bytes_per_sec, "%u %u",
+		     burst.bytes_per_sec, single.bytes_per_sec);
+}
+
+ZTEST(spim_bench, test_read_freq)
+{
+	struct spim_bench_point slow, fast;
+	int len;
+
+	for (len = 4; len <= BENCH_MAX_SIZE; len *= 4) {
+		zassert_ok(spim_set_freq(MHZ(8)));
+		bench_run("read", PKTRAM_ADDR, len, false, &slow);
+
+		zassert_ok(spim_set_freq(MHZ(32)));
+		bench_run("read", PKTRAM_ADDR, len, false, &fast);
+	}
+
+	zassert_equal(slow.xfers, 1);
+	zassert_equal(fast.xfers, 1);
+	/* Large reads scale with the clock, only the setup stays */
+	zassert_true(slow.bytes_per_sec > (MHZ(8) / 8) * 9 / 10, "%u", slow.bytes_per_sec);
+	zassert_true(fast.bytes_per_sec > 3 * slow.bytes_per_sec, "%u %u", fast.bytes_per_sec,
+		     slow.bytes_per_sec);
+}
+
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/* A write and readback per word, as in OTP programming */
+static uint64_t bracket_run(bool bracket, uint32_t *xfers)
+{
+	struct nrf70_emul_stats stats;
+	uint64_t start, best = UINT64_MAX;
+	uint32_t val, rd;
+	int round, i;
+
+	for (round = 0; round < BRACKET_ROUNDS; round++) {
+		nrf70_emul_stats_reset();
+
+		start = host_ns();
+
+		if (bracket) {
+			zassert_ok(spim_bus_begin());
+		}
+
+		for (i = 0; i < BRACKET_OPS; i++) {
+			val = 0x5A000000 | (round << 16) | i;
+			zassert_ok(spim_write(PKTRAM_ADDR + 4 * i, &val, 4));
+			zassert_ok(spim_read(PKTRAM_ADDR + 4 * i, &rd, 4));
+			zassert_equal(rd, val);
+		}
+
+		if (bracket) {
+			spim_bus_end();
+		}
+
+		best = MIN(best, host_ns() - start);
+	}
+
+	nrf70_emul_stats_get(&stats);
+	*xfers = stats.xfers;
+
+	/* Per op, a write or a read */
+	return best / (2 * BRACKET_OPS);
+}
+
+ZTEST(spim_bench, test_bracket)
+{
+	uint32_t xfers, bracket_xfers;
+	uint64_t ns, bracket_ns;
+
+	ns = bracket_run(false, &xfers);
+	bracket_ns = bracket_run(true, &bracket_xfers);
+
+	printk("bracket,ops,ns_per_op,bracketed_ns_per_op,saved_ns_per_op\n");
+	printk("bracket,%d,%u,%u,%d\n", 2 * BRACKET_OPS, (uint32_t)ns, (uint32_t)bracket_ns,
+	       (int)(ns - bracket_ns));
+
+	/* The bracket only saves work around the transactions */
+	zassert_equal(xfers, 2 * BRACKET_OPS);
+	zassert_equal(bracket_xfers, xfers);
+}
+
+ZTEST_SUITE(spim_bench, NULL, spim_bench_setup, NULL, spim_bench_after, NULL);